@@ -2,42 +2,454 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <type_traits>
+#include <bit>
+#include <numeric>
+#include <cmath>
+#include <array>
+#include <compare>
+#include <thread>
+#include <iterator>
+#include <span>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// the block kernels have AVX2 versions, chosen at run time, when the compiler can target x86-64 extensions
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIGINTEGER_AVX2 1
+#include <immintrin.h>
+#else
+#define BIGINTEGER_AVX2 0
+#endif
+
+// define BIGINTEGER_STATS to 1 before including this file to count what the hot paths do, it costs nothing otherwise
+#ifndef BIGINTEGER_STATS
+#define BIGINTEGER_STATS 0
+#endif
+
+// process-wide counters of the work done by BigInteger, with operand sizes bucketed by the bit width of their length
+class BigIntegerStats {
+ public:
+  static constexpr bool enabled = BIGINTEGER_STATS;
+
+  enum class Operation {
+    schoolbook,
+    karatsuba,
+    toom3,
+    ntt,
+    unbalanced,
+    division,
+    newton_division,
+    gcd,
+    // Rational::shrink, the reduction of a fraction by the gcd of its parts
+    shrink,
+    // leading zero limbs dropped after an operation
+    trim,
+    copy,
+    allocation,
+    pool_hit,
+    count
+  };
+  // limb counts up to 2^buckets - 1
+  static constexpr size_t buckets = 33;
+
+  // size is the length of the operand that chose the algorithm, limbs is what the operation touched or moved; for
+  // copies, allocations and pool hits that is the size of the buffer
+  static void record(Operation operation, size_t size, size_t limbs) {
+    if constexpr (enabled) {
+      Counters& counters = table[size_t(operation)];
+      counters.calls.fetch_add(1, std::memory_order_relaxed);
+      counters.limbs.fetch_add(limbs, std::memory_order_relaxed);
+      counters.histogram[std::min<size_t>(std::bit_width(size), buckets - 1)].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  static uint64_t calls(Operation operation) {
+    return table[size_t(operation)].calls.load(std::memory_order_relaxed);
+  }
+  static uint64_t limbs(Operation operation) {
+    return table[size_t(operation)].limbs.load(std::memory_order_relaxed);
+  }
+  // operations whose size had bit width bucket, that is sizes in [2^(bucket - 1), 2^bucket)
+  static uint64_t histogram(Operation operation, size_t bucket) {
+    return table[size_t(operation)].histogram[bucket].load(std::memory_order_relaxed);
+  }
+  static void reset() {
+    for (Counters& counters : table) {
+      counters.calls.store(0, std::memory_order_relaxed);
+      counters.limbs.store(0, std::memory_order_relaxed);
+      for (auto& bucket : counters.histogram) bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+  static void dump_stats(std::ostream& output = std::cerr) {
+    if constexpr (!enabled) {
+      output << "BigInteger statistics are disabled, define BIGINTEGER_STATS to 1 to collect them" << std::endl;
+      return;
+    }
+    static constexpr const char* names[] = {"schoolbook", "karatsuba", "toom3", "ntt", "unbalanced",
+                                            "division", "newton division", "gcd", "shrink", "trim",
+                                            "copy", "allocation", "pool hit"};
+    static_assert(std::size(names) == size_t(Operation::count));
+    for (size_t i = 0; i < size_t(Operation::count); ++i) {
+      Operation operation = Operation(i);
+      if (calls(operation) == 0) continue;
+      output << names[i] << ": " << calls(operation) << " calls, " << limbs(operation) << " limbs";
+      if (operation == Operation::copy) output << " (" << limbs(operation) * sizeof(uint32_t) << " bytes)";
+      output << "; sizes";
+      for (size_t bucket = 0; bucket < buckets; ++bucket) {
+        if (uint64_t count = histogram(operation, bucket)) {
+          output << " <" << (uint64_t(1) << bucket) << ": " << count;
+        }
+      }
+      output << std::endl;
+    }
+  }
+
+ private:
+  // atomics start at zero since C++20
+  struct Counters {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> limbs;
+    std::atomic<uint64_t> histogram[buckets];
+  };
+  static inline Counters table[size_t(Operation::count)];
+};
+
+// thread-local free lists of power-of-two blocks, so that the buffers of temporaries are reused instead of freed
+class BlockPool {
+ public:
+  // switching it off only affects later allocations and releases
+  static inline bool enabled = true;
+  // bytes each thread may keep in its free lists
+  static inline size_t limit = size_t(1) << 22;
+
+  // rounds bytes up to the size of the returned block
+  static void* allocate(size_t& bytes) {
+    if (!enabled || bytes > max_bytes) return heap_allocate(bytes);
+    size_t size_class = std::bit_width(std::max(bytes, min_bytes) - 1) - min_shift;
+    bytes = min_bytes << size_class;
+    if (void* block = heads[size_class]) {
+      std::memcpy(&heads[size_class], block, sizeof(void*));
+      cached_bytes -= bytes;
+      BigIntegerStats::record(BigIntegerStats::Operation::pool_hit, bytes / sizeof(uint32_t), bytes / sizeof(uint32_t));
+      return block;
+    }
+    return heap_allocate(bytes);
+  }
+  static void deallocate(void* block, size_t bytes) {
+    if (enabled && state != State::closed && std::has_single_bit(bytes) && bytes >= min_bytes && bytes <= max_bytes &&
+        cached_bytes + bytes <= limit) {
+      if (state == State::fresh) {
+        // the first cached block registers the cleanup at thread exit
+        (void)&reaper;
+        state = State::open;
+      }
+      size_t size_class = std::countr_zero(bytes) - min_shift;
+      std::memcpy(block, &heads[size_class], sizeof(void*));
+      heads[size_class] = block;
+      cached_bytes += bytes;
+      return;
+    }
+    ::operator delete(block);
+  }
+  // frees the blocks cached by the calling thread
+  static void trim() {
+    for (void*& head : heads) {
+      while (head) {
+        void* next;
+        std::memcpy(&next, head, sizeof(void*));
+        ::operator delete(head);
+        head = next;
+      }
+    }
+    cached_bytes = 0;
+  }
+  static size_t cached() {
+    return cached_bytes;
+  }
+
+ private:
+  static constexpr size_t min_bytes = 32;
+  static constexpr size_t max_bytes = size_t(1) << 20;
+  static constexpr size_t min_shift = std::countr_zero(min_bytes);
+  static constexpr size_t classes = std::countr_zero(max_bytes) - min_shift + 1;
+
+  enum class State : unsigned char { fresh, open, closed };
+
+  static void* heap_allocate(size_t bytes) {
+    BigIntegerStats::record(BigIntegerStats::Operation::allocation, bytes / sizeof(uint32_t), bytes / sizeof(uint32_t));
+    return ::operator new(bytes);
+  }
+
+  struct Reaper {
+    ~Reaper() {
+      trim();
+      // blocks released by later thread-exit or static destructors go straight to the heap
+      state = State::closed;
+    }
+  };
+
+  // trivially destructible, so that the hot paths do not go through the thread_local initialization guard
+  static inline thread_local void* heads[classes] = {};
+  static inline thread_local size_t cached_bytes = 0;
+  static inline thread_local State state = State::fresh;
+  static thread_local Reaper reaper;
+};
+
+inline thread_local BlockPool::Reaper BlockPool::reaper;
+
+// vector of trivially copyable elements that keeps the first InlineCapacity of them inside the object
+template<typename Type, size_t InlineCapacity>
+class SmallVector {
+  static_assert(std::is_trivially_copyable_v<Type>);
+  static_assert(alignof(Type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+ public:
+  SmallVector() = default;
+  explicit SmallVector(size_t count) {
+    resize(count);
+  }
+  SmallVector(std::initializer_list<Type> values) {
+    assign(values.begin(), values.end());
+  }
+  SmallVector(const Type* first, const Type* last) {
+    assign(first, last);
+  }
+  SmallVector(const SmallVector& other) {
+    assign(other.begin(), other.end());
+  }
+  SmallVector(SmallVector&& other) noexcept {
+    steal(other);
+  }
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      release();
+      steal(other);
+    }
+    return *this;
+  }
+  ~SmallVector() {
+    release();
+  }
+
+  Type& operator[](size_t index) {
+    return elements[index];
+  }
+  const Type& operator[](size_t index) const {
+    return elements[index];
+  }
+  Type* data() {
+    return elements;
+  }
+  const Type* data() const {
+    return elements;
+  }
+  Type* begin() {
+    return elements;
+  }
+  const Type* begin() const {
+    return elements;
+  }
+  Type* end() {
+    return elements + length;
+  }
+  const Type* end() const {
+    return elements + length;
+  }
+  Type& back() {
+    return elements[length - 1];
+  }
+  size_t size() const {
+    return length;
+  }
+  bool empty() const {
+    return length == 0;
+  }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity <= capacity) return;
+    size_t bytes = new_capacity * sizeof(Type);
+    Type* new_elements = static_cast<Type*>(BlockPool::allocate(bytes));
+    std::copy(elements, elements + length, new_elements);
+    release();
+    elements = new_elements;
+    capacity = bytes / sizeof(Type);
+  }
+  // new elements are zeroed
+  void resize(size_t new_length) {
+    if (new_length > capacity) reserve(std::max(new_length, 2 * capacity));
+    if (new_length > length) std::fill(elements + length, elements + new_length, Type());
+    length = new_length;
+  }
+  void clear() {
+    length = 0;
+  }
+  void push_back(const Type& value) {
+    if (length == capacity) reserve(2 * capacity);
+    elements[length++] = value;
+  }
+  void pop_back() {
+    --length;
+  }
+  void assign(const Type* first, const Type* last) {
+    size_t new_length = last - first;
+    if (new_length > capacity) {
+      // first may point into the old elements
+      SmallVector copy;
+      copy.reserve(new_length);
+      std::copy(first, last, copy.elements);
+      copy.length = new_length;
+      *this = std::move(copy);
+      return;
+    }
+    std::copy(first, last, elements);
+    length = new_length;
+  }
+  void insert(Type* position, size_t count, const Type& value) {
+    size_t index = position - elements;
+    resize(length + count);
+    std::copy_backward(elements + index, elements + length - count, elements + length);
+    std::fill(elements + index, elements + index + count, value);
+  }
+  void erase(Type* first, Type* last) {
+    std::copy(last, elements + length, first);
+    length -= last - first;
+  }
+
+ private:
+  Type inline_elements[InlineCapacity];
+  Type* elements = inline_elements;
+  size_t length = 0;
+  size_t capacity = InlineCapacity;
+
+  bool is_inline() const {
+    return elements == inline_elements;
+  }
+  void release() {
+    if (!is_inline()) {
+      BlockPool::deallocate(elements, capacity * sizeof(Type));
+      elements = inline_elements;
+      capacity = InlineCapacity;
+    }
+  }
+  // other is left empty
+  void steal(SmallVector& other) {
+    if (other.is_inline()) {
+      std::copy(other.elements, other.elements + other.length, inline_elements);
+    } else {
+      elements = other.elements;
+      capacity = other.capacity;
+      other.elements = other.inline_elements;
+      other.capacity = InlineCapacity;
+    }
+    length = other.length;
+    other.length = 0;
+  }
+};
+
+// the radix of an integer literal and where its digits start, with the same prefixes as the built-in literals
+constexpr unsigned integer_literal_radix(const char* digits, size_t length, size_t& begin) {
+  begin = 0;
+  if (length < 2 || digits[0] != '0') return 10;
+  if (digits[1] == 'x' || digits[1] == 'X') {
+    begin = 2;
+    return 16;
+  }
+  if (digits[1] == 'b' || digits[1] == 'B') {
+    begin = 2;
+    return 2;
+  }
+  begin = 1;
+  return 8;
+}
+// the value of a digit, or 36 for a character that is no digit at all
+constexpr unsigned integer_literal_digit(char digit) {
+  if (digit >= '0' && digit <= '9') return digit - '0';
+  if (digit >= 'a' && digit <= 'z') return digit - 'a' + 10;
+  if (digit >= 'A' && digit <= 'Z') return digit - 'A' + 10;
+  return 36;
+}
+// false for floating-point literals such as 1.5 or 1e3, which the raw literal operator template also receives
+template<char... Digits>
+consteval bool is_integer_literal() {
+  constexpr char digits[] = {Digits...};
+  size_t begin;
+  unsigned radix = integer_literal_radix(digits, sizeof...(Digits), begin);
+  if (begin == sizeof...(Digits)) return radix == 8;
+  for (size_t i = begin; i < sizeof...(Digits); ++i) {
+    if (digits[i] != '\'' && integer_literal_digit(digits[i]) >= radix) return false;
+  }
+  return true;
+}
+
+class BigInteger;
+class FusedFactor;
+class FusedProduct;
+template<size_t Count>
+struct FusedSum;
+
+// one term of a fused sum: a number, or a product of two when second is set
+struct FusedTerm {
+  const BigInteger* first;
+  const BigInteger* second;
+  bool negative;
+};
+
+template<typename Type>
+struct IsFusedSum : std::false_type {};
+template<size_t Count>
+struct IsFusedSum<FusedSum<Count>> : std::true_type {};
+
+template<typename Type>
+concept FusedExpression = std::is_same_v<Type, FusedFactor> || std::is_same_v<Type, FusedProduct> ||
+                          IsFusedSum<Type>::value;
+template<typename Type>
+concept FusedOperand = FusedExpression<Type> || std::is_same_v<Type, BigInteger>;
 
 class BigInteger {
  public:
   BigInteger() = default;
   BigInteger(long long num) {
-    blocks_amount = 1;
-    blocks = std::vector<long long>(blocks_amount);
     is_positive = num >= 0;
-    blocks[0] = std::abs(num);
+    uint64_t magnitude = is_positive ? uint64_t(num) : -uint64_t(num);
+    blocks = {limb(magnitude), limb(magnitude >> limb_bits)};
+    blocks_amount = 2;
+    resize();
   }
+  // an optional sign and at least one decimal digit, anything else throws std::invalid_argument
   BigInteger(const std::string& num) {
-    if (num[0] == '-') {
-      is_positive = true;
-    } else {
-      is_positive = false;
+    bool is_negative = !num.empty() && num[0] == '-';
+    bool has_sign = !num.empty() && (num[0] == '-' || num[0] == '+');
+    if (num.size() == size_t(has_sign) ||
+        !std::all_of(num.begin() + has_sign, num.end(), [](char digit) { return digit >= '0' && digit <= '9'; })) {
+      throw std::invalid_argument("BigInteger: not a decimal number");
     }
-    long long in_blocks_amount = num.size() - is_positive;
-    blocks_amount = in_blocks_amount / pr + 1;
-    blocks = std::vector<long long>(blocks_amount);
-    int counter = 0;
-    for (long long i = num.size() - 1; i >= 1 - is_positive; i -= pr) {
-      if (i >= pr - 1 + 1 - is_positive) {
-        blocks[counter] = std::stoi(num.substr(i - pr + 1, pr));
-        counter++;
-      } else {
-        blocks[counter] = std::stoi(num.substr(1 - is_positive, i + is_positive));
-      }
-    }
-    resize();
+    *this = parse_decimal(num.data() + has_sign, num.size() - has_sign);
+    is_positive = !is_negative;
     adduction();
   }
   BigInteger(const BigInteger& num) {
+    BigIntegerStats::record(BigIntegerStats::Operation::copy, num.blocks_amount, num.blocks_amount);
     blocks_amount = num.blocks_amount;
     blocks = num.blocks;
     is_positive = num.is_positive;
   }
+  BigInteger(BigInteger&& num) noexcept {
+    *this = std::move(num);
+  }
 
   BigInteger& operator+=(const BigInteger& num) {
     bool old_sign = is_positive;
@@ -70,18 +482,10 @@ class BigInteger {
     return *this;
   }
   BigInteger& operator*=(const BigInteger& num) {
-    std::vector<long long> copy(blocks_amount + num.blocks_amount);
-    for (long long i = 0; i < blocks_amount; ++i) {
-      for (int j = 0; j < num.blocks_amount; ++j) {
-        copy[i + j] += blocks[i] * num.blocks[j];
-        if (copy[i + j] > base) {
-          copy[i + j + 1] += copy[i + j] / base;
-          copy[i + j] %= base;
-        }
-      }
-    }
+    Limbs product(blocks_amount + num.blocks_amount);
+    multiply_unsigned(product.data(), blocks.data(), blocks_amount, num.blocks.data(), num.blocks_amount);
     is_positive = !(is_positive ^ num.is_positive);
-    blocks = copy;
+    blocks = std::move(product);
     blocks_amount += num.blocks_amount;
     resize();
     adduction();
@@ -96,17 +500,82 @@ class BigInteger {
   }
   BigInteger& operator%=(const BigInteger& num) {
     blocks = divide_unsigned(num);
-    blocks_amount = blocks.blocks_amount();
+    blocks_amount = blocks.size();
     resize();
     adduction();
     return *this;
   }
   BigInteger& operator=(const BigInteger& num) {
+    BigIntegerStats::record(BigIntegerStats::Operation::copy, num.blocks_amount, num.blocks_amount);
     blocks_amount = num.blocks_amount;
     blocks = num.blocks;
     is_positive = num.is_positive;
     return *this;
   }
+  // the moved-from number is left equal to zero
+  BigInteger& operator=(BigInteger&& num) noexcept {
+    if (this != &num) {
+      blocks = std::move(num.blocks);
+      blocks_amount = num.blocks_amount;
+      is_positive = num.is_positive;
+      num.blocks.push_back(0);
+      num.blocks_amount = 1;
+      num.is_positive = true;
+    }
+    return *this;
+  }
+  // *this += num_1 * num_2 without a temporary BigInteger
+  BigInteger& add_mul(const BigInteger& num_1, const BigInteger& num_2) {
+    return add_product(num_1, num_2, num_1.is_positive == num_2.is_positive);
+  }
+  // *this -= num_1 * num_2 without a temporary BigInteger
+  BigInteger& sub_mul(const BigInteger& num_1, const BigInteger& num_2) {
+    return add_product(num_1, num_2, num_1.is_positive != num_2.is_positive);
+  }
+  // an expression built from fused(...) is evaluated here in one pass, see FusedSum
+  template<FusedExpression Expression>
+  BigInteger(const Expression& expression);
+  template<FusedExpression Expression>
+  BigInteger& operator=(const Expression& expression);
+  template<FusedExpression Expression>
+  BigInteger& operator+=(const Expression& expression);
+  template<FusedExpression Expression>
+  BigInteger& operator-=(const Expression& expression);
+  // multiplies by 2^shift
+  BigInteger& operator<<=(size_t shift) {
+    shift_bits_left(int(shift % limb_bits));
+    shift_blocks(shift / limb_bits);
+    return *this;
+  }
+  // divides by 2^shift rounding down, like the shift of a built-in integer
+  BigInteger& operator>>=(size_t shift) {
+    size_t count = shift / limb_bits;
+    int bits = int(shift % limb_bits);
+    bool is_lost = false;
+    for (size_t i = 0; i < std::min<size_t>(count, blocks_amount) && !is_lost; ++i) is_lost = blocks[i] != 0;
+    if (count < size_t(blocks_amount) && (blocks[count] & ((limb(1) << bits) - 1)) != 0) is_lost = true;
+    bool was_positive = is_positive;
+    truncate_blocks(count);
+    shift_blocks_right(blocks.data(), blocks_amount, bits);
+    resize();
+    is_positive = was_positive;
+    adduction();
+    if (!was_positive && is_lost) {
+      *this -= 1;
+    }
+    return *this;
+  }
+  // negative numbers take part in the bitwise operations as two's complement with infinitely many leading ones,
+  // like the built-in integers
+  BigInteger& operator&=(const BigInteger& num) {
+    return bitwise(num, [](limb first, limb second) { return first & second; });
+  }
+  BigInteger& operator|=(const BigInteger& num) {
+    return bitwise(num, [](limb first, limb second) { return first | second; });
+  }
+  BigInteger& operator^=(const BigInteger& num) {
+    return bitwise(num, [](limb first, limb second) { return first ^ second; });
+  }
   BigInteger& operator++() {
     *this += 1;
     return *this;
@@ -126,39 +595,134 @@ class BigInteger {
     return copy;
   }
 
+  // both conversions keep the low bits of the value, like the conversions between built-in integers
   explicit operator int() {
-    long long result = 0;
-    if (blocks_amount > 1) result += blocks[1];
-    if (blocks_amount > 0) result += blocks[0] * base;
-    return int(result);
+    return int(static_cast<long long>(*this));
   }
   explicit operator long long() {
-    return blocks[0];
+    uint64_t magnitude = blocks[0];
+    if (blocks_amount > 1) magnitude |= uint64_t(blocks[1]) << limb_bits;
+    return (long long) (is_positive ? magnitude : -magnitude);
   }
   explicit operator bool() {
-    if (is_positive && blocks_amount > 0 && blocks[0] > 0)
-      return true;
-    return false;
+    return !(blocks_amount == 1 && blocks[0] == 0);
   }
   friend bool operator<(const BigInteger& num_1, const BigInteger& num_2);
+  friend BigInteger operator-(BigInteger&& num);
+  friend BigInteger gcd(const BigInteger& num_1, const BigInteger& num_2);
+  template<size_t Bits>
+  friend class FixedBigInteger;
+  friend class BigIntegerView;
+  friend std::istream& operator>>(std::istream& input, BigInteger& biggie);
+  template<char... Digits>
+    requires (is_integer_literal<Digits...>())
+  friend BigInteger operator""_bi();
   void clear() {
     blocks.clear();
     blocks_amount = 0;
   }
   std::string toString() const {
     std::string output;
+    toString(output);
+    return output;
+  }
+  // writes the number into output, reusing its memory
+  void toString(std::string& output) const {
+    output.clear();
+    // a block holds less than 10 decimal digits
+    output.reserve(blocks_amount * 10 + 1);
     if (!is_positive) {
       output.push_back('-');
     }
-    for (long long i = blocks_amount - 1; i >= 0; --i) {
-      auto number = std::to_string(blocks[i]);
-      if (i == blocks_amount - 1) {
-        output += number;
-      } else {
-        output += std::string(pr - number.length(), '0') + number;
-      }
+    append_decimal(output, abs());
+  }
+  // the binary format: a version byte, a sign byte (1 for negative numbers), two zero bytes, the number of
+  // blocks as 4 bytes and the blocks themselves, 4 bytes each, all little-endian; records stay 4-byte aligned
+  static constexpr std::byte serial_version{1};
+  static constexpr size_t serial_header_size = 8;
+  size_t serialized_size() const {
+    return serial_header_size + sizeof(limb) * blocks_amount;
+  }
+  // writes the record to the start of output, returns its size
+  size_t serialize(std::span<std::byte> output) const {
+    size_t size = serialized_size();
+    if (output.size() < size) throw std::length_error("BigInteger::serialize");
+    output[0] = serial_version;
+    output[1] = std::byte(!is_positive);
+    output[2] = output[3] = std::byte{0};
+    store_little_endian(output.data() + 4, limb(blocks_amount));
+    std::byte* target = output.data() + serial_header_size;
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(target, blocks.data(), sizeof(limb) * blocks_amount);
+    } else {
+      for (long long i = 0; i < blocks_amount; ++i) store_little_endian(target + sizeof(limb) * i, blocks[i]);
     }
-    return output;
+    return size;
+  }
+  // reads the record at the start of input, its size is serialized_size() of the result
+  static BigInteger deserialize(std::span<const std::byte> input) {
+    size_t length = serial_length(input);
+    BigInteger result;
+    result.blocks.resize(length);
+    const std::byte* source = input.data() + serial_header_size;
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(result.blocks.data(), source, sizeof(limb) * length);
+    } else {
+      for (size_t i = 0; i < length; ++i) result.blocks[i] = load_little_endian(source + sizeof(limb) * i);
+    }
+    result.blocks_amount = length;
+    result.is_positive = input[1] == std::byte{0};
+    result.resize();
+    result.adduction();
+    return result;
+  }
+  // reusable context for arithmetic modulo a fixed positive number
+  class Modulus;
+  // this^exponent mod mod in [0, mod) for mod > 0, a negative exponent throws std::domain_error
+  BigInteger pow_mod(const BigInteger& exponent, const BigInteger& mod) const;
+  // the product of a range of numbers, multiplied as a balanced tree so that the factors of every
+  // multiplication have about the same length; 1 for an empty range
+  template<typename Iterator>
+  static BigInteger product(Iterator first, Iterator last) {
+    size_t length = std::distance(first, last);
+    if (length <= 16) {
+      BigInteger result = 1;
+      for (; first != last; ++first) result *= *first;
+      return result;
+    }
+    Iterator middle = std::next(first, length / 2);
+    BigInteger result = product(first, middle);
+    result *= product(middle, last);
+    return result;
+  }
+  static BigInteger factorial(size_t n);
+  // the roots are rounded down and taken of non-negative numbers; negative numbers and iroot(0) throw
+  // std::domain_error, and negative numbers are neither perfect squares nor perfect powers
+  BigInteger isqrt() const;
+  BigInteger iroot(size_t n) const;
+  bool is_perfect_square() const;
+  // whether the number is a^k for some integers a and k >= 2
+  bool is_perfect_power() const;
+  // n choose k, 0 for k > n
+  static BigInteger binomial(size_t n, size_t k);
+  // -1, 0 or 1 as the number is less than, equal to or greater than num, in one pass over the blocks
+  int compare(const BigInteger& num) const {
+    if (is_positive != num.is_positive) return is_positive ? 1 : -1;
+    int result = compare_blocks(blocks.data(), blocks_amount, num.blocks.data(), num.blocks_amount);
+    return is_positive ? result : -result;
+  }
+  int sign() const {
+    if (!is_positive) return -1;
+    return blocks_amount == 1 && blocks[0] == 0 ? 0 : 1;
+  }
+  // the number of set bits of the absolute value
+  size_t popcount() const {
+    size_t result = 0;
+    for (long long i = 0; i < blocks_amount; ++i) result += std::popcount(blocks[i]);
+    return result;
+  }
+  size_t bit_length() const {
+    return blocks_amount * limb_bits - std::countl_zero(blocks[blocks_amount - 1]);
   }
   BigInteger abs() const {
     BigInteger copy = *this;
@@ -166,37 +730,620 @@ class BigInteger {
     return copy;
   }
 
+  // multiplication switches to Karatsuba and then to Toom-3 once the shorter operand reaches these sizes (in blocks)
+  static inline size_t karatsuba_threshold = 32;
+  static inline size_t toom3_threshold = 300;
+  // above this size both operands are multiplied by the number-theoretic transform
+  static inline size_t ntt_threshold = 6000;
+  // division goes through a Newton reciprocal once both the divisor and the quotient are this long (in blocks)
+  static inline size_t newton_threshold = 3000;
+  // decimal conversion splits numbers by powers of 10 down to this size (in blocks)
+  static inline size_t decimal_threshold = 30;
+  // addition, subtraction and comparison of blocks use AVX2 when this is set and the processor has it
+  static inline bool vectorize = true;
+  // multiplications whose shorter operand reaches parallel_threshold blocks share their work among up to
+  // thread_count threads
+  static inline size_t thread_count = 1;
+  // threads kept by the pool behind the parallel multiplication, one fewer than the largest thread_count used
+  static size_t worker_threads() {
+    return WorkerPool::instance().size();
+  }
+  static inline size_t parallel_threshold = 1000;
+
  private:
-  std::vector<long long> blocks; // in reverse order
-  long long blocks_amount = 0;
-  int base = 1e9;
+  using limb = uint32_t;
+  using wide = uint64_t; // holds a product of two limbs plus two more limbs
+  // a long long and the results of most operations on it fit without allocation
+  using Limbs = SmallVector<limb, 4>;
+
+  Limbs blocks = {0}; // binary, in reverse order
+  long long blocks_amount = 1;
+  static constexpr int limb_bits = 32;
+  static constexpr wide base = wide(1) << limb_bits;
   bool is_positive = true;
-  int pr = 9;
-  void adduction() {
-    for (long long i = 0; i < blocks_amount; ++i) {
-      if (blocks[i] >= base) {
-        if (i == blocks_amount - 1) {
-          blocks.push_back(0);
-          blocks_amount++;
-        }
-        blocks[i + 1] += blocks[i] / base;
-        blocks[i] %= base;
+  // decimal digits are converted pr at a time
+  static constexpr int pr = 9;
+  static constexpr limb decimal_base = 1'000'000'000;
+
+  // blocks of an integer literal, worked out by the compiler; a digit takes at most 4 bits
+  template<char... Digits>
+  static consteval std::array<limb, sizeof...(Digits) / 8 + 1> literal_blocks() {
+    constexpr char digits[] = {Digits...};
+    std::array<limb, sizeof...(Digits) / 8 + 1> result{};
+    size_t begin;
+    limb radix = integer_literal_radix(digits, sizeof...(Digits), begin);
+    for (size_t i = begin; i < sizeof...(Digits); ++i) {
+      char digit = digits[i];
+      if (digit == '\'') continue;
+      limb value = integer_literal_digit(digit);
+      // not reachable through operator""_bi, whose constraint rejects such literals
+      if (value >= radix) throw std::invalid_argument("_bi: not an integer literal");
+      multiply_blocks_small(result.data(), result.size(), radix);
+      add_blocks(result.data(), result.data(), result.size(), &value, 1);
+    }
+    return result;
+  }
+  static BigInteger from_blocks(const limb* source, size_t length) {
+    BigInteger result;
+    result.blocks.assign(source, source + length);
+    if (result.blocks.empty()) result.blocks.push_back(0);
+    result.blocks_amount = result.blocks.size();
+    result.resize();
+    return result;
+  }
+#if BIGINTEGER_AVX2
+  static inline const bool has_avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+
+  static bool use_avx2() {
+    return vectorize && has_avx2;
+  }
+  // lanes of a vector of 8 blocks whose bits are set in mask become all ones
+  [[gnu::target("avx2")]] static __m256i lane_mask(unsigned mask) {
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(mask)), bits), bits);
+  }
+  // the lanes where first is above second as unsigned numbers
+  [[gnu::target("avx2")]] static unsigned above_mask(__m256i first, __m256i second) {
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    __m256i above = _mm256_cmpgt_epi32(_mm256_xor_si256(first, sign), _mm256_xor_si256(second, sign));
+    return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(above)));
+  }
+  [[gnu::target("avx2")]] static unsigned equal_mask(__m256i first, __m256i second) {
+    return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(first, second))));
+  }
+  // the lanes that receive a carry: the generated carries move one lane up and run through the propagating
+  // lanes by an ordinary addition of the masks; bit 8 is the carry out of the vector
+  static unsigned carry_mask(unsigned generate, unsigned propagate, unsigned carry) {
+    return ((generate << 1 | carry) + propagate) ^ propagate;
+  }
+  // result = first + second over length blocks, a multiple of 8; returns carry
+  [[gnu::target("avx2")]] static limb add_blocks_avx2(limb* result, const limb* first, const limb* second,
+                                                      size_t length) {
+    const __m256i ones = _mm256_set1_epi32(-1);
+    unsigned carry = 0;
+    for (size_t i = 0; i < length; i += 8) {
+      __m256i first_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+      __m256i sum = _mm256_add_epi32(first_lanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i)));
+      unsigned carries = carry_mask(above_mask(first_lanes, sum), equal_mask(sum, ones), carry);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_sub_epi32(sum, lane_mask(carries)));
+      carry = carries >> 8;
+    }
+    return limb(carry);
+  }
+  // first -= second over length blocks, a multiple of 8; returns borrow
+  [[gnu::target("avx2")]] static limb subtract_blocks_avx2(limb* first, const limb* second, size_t length) {
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned borrow = 0;
+    for (size_t i = 0; i < length; i += 8) {
+      __m256i first_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+      __m256i second_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i));
+      __m256i difference = _mm256_sub_epi32(first_lanes, second_lanes);
+      unsigned borrows = carry_mask(above_mask(second_lanes, first_lanes), equal_mask(difference, zero), borrow);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(first + i), _mm256_add_epi32(difference, lane_mask(borrows)));
+      borrow = borrows >> 8;
+    }
+    return limb(borrow);
+  }
+  // skips the equal vectors of 8 blocks from the top, returns how many low blocks are left to compare
+  [[gnu::target("avx2")]] static size_t unequal_length_avx2(const limb* first, const limb* second, size_t length) {
+    for (; length >= 8; length -= 8) {
+      unsigned equal = equal_mask(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + length - 8)),
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + length - 8)));
+      if (equal != 0xFF) return length - 8 + std::bit_width(~equal & 0xFF);
+    }
+    return length;
+  }
+#endif
+  // result = first + second, first_length >= second_length, result may alias first; returns carry
+  static constexpr limb add_blocks(limb* result, const limb* first, size_t first_length,
+                                   const limb* second, size_t second_length) {
+    wide carry = 0;
+    size_t i = 0;
+#if BIGINTEGER_AVX2
+    if (!std::is_constant_evaluated() && second_length >= 8 && use_avx2()) {
+      i = second_length & ~size_t(7);
+      carry = add_blocks_avx2(result, first, second, i);
+    }
+#endif
+    for (; i < first_length; ++i) {
+      wide current = first[i] + carry + (i < second_length ? second[i] : 0);
+      result[i] = limb(current);
+      carry = current >> limb_bits;
+    }
+    return limb(carry);
+  }
+  // lengths are taken without leading zero blocks
+  static constexpr int compare_blocks(const limb* first, size_t first_length, const limb* second, size_t second_length) {
+    if (first_length != second_length) return first_length < second_length ? -1 : 1;
+#if BIGINTEGER_AVX2
+    if (!std::is_constant_evaluated() && first_length >= 8 && use_avx2()) {
+      first_length = unequal_length_avx2(first, second, first_length);
+    }
+#endif
+    for (size_t i = first_length; i > 0; --i) {
+      if (first[i - 1] != second[i - 1]) return first[i - 1] < second[i - 1] ? -1 : 1;
+    }
+    return 0;
+  }
+  // first -= second in place, first must be not less than second; the borrow runs up to first_length
+  static constexpr void subtract_blocks(limb* first, size_t first_length, const limb* second, size_t second_length) {
+    wide borrow = 0;
+    size_t i = 0;
+#if BIGINTEGER_AVX2
+    if (!std::is_constant_evaluated() && second_length >= 8 && use_avx2()) {
+      i = second_length & ~size_t(7);
+      borrow = subtract_blocks_avx2(first, second, i);
+    }
+#endif
+    for (; i < first_length && (i < second_length || borrow); ++i) {
+      wide current = first[i] - borrow - (i < second_length ? second[i] : 0);
+      first[i] = limb(current);
+      borrow = (current >> limb_bits) & 1;
+    }
+  }
+  // threads that the multiplication running on this thread may use, 0 outside of parallel work
+  static inline thread_local size_t thread_budget = 0;
+
+  static size_t available_threads() {
+    return thread_budget != 0 ? thread_budget : std::max<size_t>(thread_count, 1);
+  }
+  static size_t threads_for(size_t length) {
+    return length >= parallel_threshold ? available_threads() : 1;
+  }
+  // threads kept between the parallel calls; a thread waiting for the parts of its job runs queued parts meanwhile,
+  // so nested parallel work cannot starve, and the budgets keep the busy threads within thread_count
+  class WorkerPool {
+   public:
+    struct Job {
+      void (*call)(const void* context, size_t part);
+      const void* context;
+      // parts handed to the pool and not finished yet, guarded by the pool's mutex
+      size_t pending;
+    };
+
+    static WorkerPool& instance() {
+      static WorkerPool pool;
+      return pool;
+    }
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
       }
-      if (blocks[i] < 0) {
-        if (i == blocks_amount - 1) {
-          blocks[i] *= -1;
-          is_positive = false;
+      ready.notify_all();
+      for (std::thread& worker : workers) worker.join();
+    }
+    size_t size() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return workers.size();
+    }
+    // part 0 runs on the calling thread, the others on the pool; returns when all of them are done
+    void run(Job& job, size_t parts) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (workers.size() < parts - 1) workers.emplace_back([this] { work(); });
+        for (size_t part = 1; part < parts; ++part) tasks.push_back({&job, part});
+        job.pending = parts - 1;
+      }
+      ready.notify_all();
+      job.call(job.context, 0);
+      std::unique_lock<std::mutex> lock(mutex);
+      while (job.pending != 0) {
+        if (tasks.empty()) {
+          finished.wait(lock);
         } else {
-          blocks[i] += base;
-          blocks[i + 1]--;
+          execute(lock);
+        }
+      }
+    }
+
+   private:
+    struct Task {
+      Job* job;
+      size_t part;
+    };
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable finished;
+    std::deque<Task> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    // runs the first queued task, the lock is released meanwhile
+    void execute(std::unique_lock<std::mutex>& lock) {
+      Task task = tasks.front();
+      tasks.pop_front();
+      lock.unlock();
+      task.job->call(task.job->context, task.part);
+      lock.lock();
+      if (--task.job->pending == 0) finished.notify_all();
+    }
+    void work() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty()) return;
+        execute(lock);
+      }
+    }
+  };
+
+  // calls function(begin, end) on consecutive parts of [0, count), at most one per thread; every part gets its
+  // share of the threads for the parallel work nested in it
+  template<typename Function>
+  static void parallel_for(size_t count, size_t threads, const Function& function) {
+    size_t parts = std::min(count, std::max<size_t>(threads, 1));
+    auto run = [&](size_t part) {
+      size_t old_budget = thread_budget;
+      thread_budget = threads / parts + (part < threads % parts);
+      function(count * part / parts, count * (part + 1) / parts);
+      thread_budget = old_budget;
+    };
+    if (parts <= 1) {
+      if (parts == 1) run(0);
+      return;
+    }
+    using Run = decltype(run);
+    typename WorkerPool::Job job{[](const void* context, size_t part) { (*static_cast<const Run*>(context))(part); },
+                                 &run, 0};
+    WorkerPool::instance().run(job, parts);
+  }
+  // result (first_length + second_length blocks, zeroed) = first * second
+  static constexpr void mul_schoolbook(limb* result, const limb* first, size_t first_length,
+                                       const limb* second, size_t second_length) {
+    for (size_t i = 0; i < first_length; ++i) {
+      if (first[i] == 0) continue;
+      wide carry = 0;
+      for (size_t j = 0; j < second_length; ++j) {
+        wide current = wide(first[i]) * second[j] + result[i + j] + carry;
+        result[i + j] = limb(current);
+        carry = current >> limb_bits;
+      }
+      result[i + second_length] = limb(carry);
+    }
+  }
+  // accumulator[0..length) += first * second, the accumulator has room for the sum; the carry of each row runs up
+  static constexpr void mul_add_schoolbook(limb* accumulator, size_t length, const limb* first, size_t first_length,
+                                           const limb* second, size_t second_length) {
+    for (size_t i = 0; i < first_length; ++i) {
+      if (first[i] == 0) continue;
+      wide carry = 0;
+      for (size_t j = 0; j < second_length; ++j) {
+        wide current = wide(first[i]) * second[j] + accumulator[i + j] + carry;
+        accumulator[i + j] = limb(current);
+        carry = current >> limb_bits;
+      }
+      for (size_t k = i + second_length; carry != 0 && k < length; ++k) {
+        wide current = wide(accumulator[k]) + carry;
+        accumulator[k] = limb(current);
+        carry = current >> limb_bits;
+      }
+    }
+  }
+  // first_length >= second_length > first_length / 2
+  static void mul_karatsuba(limb* result, const limb* first, size_t first_length,
+                            const limb* second, size_t second_length) {
+    size_t half = (first_length + 1) / 2;
+    size_t high_length = second_length - std::min(half, second_length);
+    std::fill(result, result + first_length + second_length, 0);
+    // both sums and their product share one allocation
+    Limbs scratch(4 * half + 4);
+    limb* first_sum = scratch.data();
+    limb* second_sum = first_sum + half + 1;
+    limb* middle = second_sum + half + 1;
+    size_t middle_size = 2 * half + 2;
+    first_sum[half] = add_blocks(first_sum, first, half, first + half, first_length - half);
+    second_sum[half] = add_blocks(second_sum, second, std::min(half, second_length), second + half, high_length);
+    // the three products write into disjoint blocks
+    parallel_for(3, threads_for(second_length), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (i == 0) {
+          multiply_unsigned(result, first, half, second, std::min(half, second_length));
+        } else if (i == 1 && high_length > 0) {
+          multiply_unsigned(result + 2 * half, first + half, first_length - half, second + half, high_length);
+        } else if (i == 2) {
+          multiply_unsigned(middle, first_sum, half + 1, second_sum, half + 1);
+        }
+      }
+    });
+    subtract_blocks(middle, middle_size, result, 2 * half);
+    subtract_blocks(middle, middle_size, result + 2 * half, first_length + second_length - 2 * half);
+    size_t middle_length = std::min(middle_size, first_length + second_length - half);
+    limb carry = add_blocks(result + half, result + half, first_length + second_length - half,
+                            middle, middle_length);
+    (void) carry; // the product always fits into first_length + second_length blocks
+  }
+  // Bodrato's sequence: evaluation in 0, 1, -1, -2 and infinity
+  static void mul_toom3(limb* result, const limb* first, size_t first_length,
+                        const limb* second, size_t second_length) {
+    size_t part = (first_length + 2) / 3;
+    auto split = [part](const limb* source, size_t length, size_t index) {
+      size_t begin = std::min(length, part * index);
+      size_t end = index == 2 ? length : std::min(length, part * (index + 1));
+      return from_blocks(source + begin, end - begin);
+    };
+    BigInteger first_0 = split(first, first_length, 0);
+    BigInteger first_1 = split(first, first_length, 1);
+    BigInteger first_2 = split(first, first_length, 2);
+    BigInteger second_0 = split(second, second_length, 0);
+    BigInteger second_1 = split(second, second_length, 1);
+    BigInteger second_2 = split(second, second_length, 2);
+
+    // values of both polynomials in 1, -1 and -2
+    BigInteger first_one = first_0;
+    first_one += first_2;
+    BigInteger first_minus_one = first_one;
+    first_one += first_1;
+    first_minus_one -= first_1;
+    BigInteger first_minus_two = first_minus_one;
+    first_minus_two += first_2;
+    first_minus_two *= 2;
+    first_minus_two -= first_0;
+    BigInteger second_one = second_0;
+    second_one += second_2;
+    BigInteger second_minus_one = second_one;
+    second_one += second_1;
+    second_minus_one -= second_1;
+    BigInteger second_minus_two = second_minus_one;
+    second_minus_two += second_2;
+    second_minus_two *= 2;
+    second_minus_two -= second_0;
+
+    BigInteger at_zero = first_0;
+    BigInteger at_one = first_one;
+    BigInteger at_minus_one = first_minus_one;
+    BigInteger at_minus_two = first_minus_two;
+    BigInteger at_infinity = first_2;
+    BigInteger* products[] = {&at_zero, &at_one, &at_minus_one, &at_minus_two, &at_infinity};
+    const BigInteger* factors[] = {&second_0, &second_one, &second_minus_one, &second_minus_two, &second_2};
+    parallel_for(5, threads_for(second_length), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) *products[i] *= *factors[i];
+    });
+
+    // interpolation
+    BigInteger coefficient_3 = at_minus_two;
+    coefficient_3 -= at_one;
+    coefficient_3.divide_small(3);
+    BigInteger coefficient_1 = at_one;
+    coefficient_1 -= at_minus_one;
+    coefficient_1.divide_small(2);
+    BigInteger coefficient_2 = at_minus_one;
+    coefficient_2 -= at_zero;
+    coefficient_3 -= coefficient_2;
+    coefficient_3.divide_small(2);
+    coefficient_3.is_positive = !coefficient_3.is_positive;
+    coefficient_3.adduction();
+    coefficient_3 += at_infinity;
+    coefficient_3 += at_infinity;
+    coefficient_2 += coefficient_1;
+    coefficient_2 -= at_infinity;
+    coefficient_1 -= coefficient_3;
+
+    std::fill(result, result + first_length + second_length, 0);
+    const BigInteger* coefficients[] = {&at_zero, &coefficient_1, &coefficient_2, &coefficient_3, &at_infinity};
+    for (size_t i = 0; i < 5; ++i) {
+      size_t offset = part * i;
+      if (offset >= first_length + second_length) break;
+      const BigInteger& coefficient = *coefficients[i];
+      size_t length = std::min<size_t>(coefficient.blocks_amount, first_length + second_length - offset);
+      add_blocks(result + offset, result + offset, first_length + second_length - offset,
+                 coefficient.blocks.data(), length);
+    }
+  }
+  // three-prime NTT: the product of the primes is above 2^23 * base^2, so no convolution coefficient is lost
+  static constexpr uint32_t ntt_primes[3] = {167772161, 469762049, 2013265921};
+  static constexpr uint32_t ntt_roots[3] = {3, 3, 31};
+  static constexpr size_t ntt_max_length = size_t(1) << 24;
+
+  static constexpr uint32_t power_mod(uint64_t value, uint64_t exponent, uint32_t mod) {
+    uint64_t result = 1;
+    value %= mod;
+    while (exponent > 0) {
+      if (exponent & 1) result = result * value % mod;
+      value = value * value % mod;
+      exponent >>= 1;
+    }
+    return uint32_t(result);
+  }
+  template<uint32_t mod, uint32_t root>
+  static void ntt(std::vector<uint32_t>& values, bool inverse) {
+    size_t length = values.size();
+    for (size_t i = 1, j = 0; i < length; ++i) {
+      size_t bit = length >> 1;
+      for (; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if (i < j) std::swap(values[i], values[j]);
+    }
+    std::vector<uint32_t> roots(length / 2);
+    size_t threads = available_threads();
+    for (size_t half = 1; half < length; half <<= 1) {
+      uint64_t step = power_mod(root, (mod - 1) / (2 * half), mod);
+      if (inverse) step = power_mod(step, mod - 2, mod);
+      roots[0] = 1;
+      for (size_t j = 1; j < half; ++j) roots[j] = uint32_t(roots[j - 1] * step % mod);
+      // butterfly k pairs the blocks i + j and i + j + half
+      parallel_for(length / 2, threads, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+          size_t j = k & (half - 1);
+          size_t i = 2 * k - j;
+          uint32_t even = values[i];
+          uint32_t odd = uint32_t(uint64_t(values[i + half]) * roots[j] % mod);
+          values[i] = even + odd >= mod ? even + odd - mod : even + odd;
+          values[i + half] = even >= odd ? even - odd : even + mod - odd;
         }
+      });
+    }
+    if (inverse) {
+      uint64_t length_inverse = power_mod(length, mod - 2, mod);
+      for (auto& value : values) value = uint32_t(value * length_inverse % mod);
+    }
+  }
+  template<uint32_t mod, uint32_t root>
+  static std::vector<uint32_t> ntt_convolution(const limb* first, size_t first_length,
+                                               const limb* second, size_t second_length, size_t length) {
+    std::vector<uint32_t> first_values(length);
+    for (size_t i = 0; i < first_length; ++i) first_values[i] = first[i] % mod;
+    ntt<mod, root>(first_values, false);
+    if (first == second && first_length == second_length) {
+      for (auto& value : first_values) value = uint32_t(uint64_t(value) * value % mod);
+    } else {
+      std::vector<uint32_t> second_values(length);
+      for (size_t i = 0; i < second_length; ++i) second_values[i] = second[i] % mod;
+      ntt<mod, root>(second_values, false);
+      for (size_t i = 0; i < length; ++i) first_values[i] = uint32_t(uint64_t(first_values[i]) * second_values[i] % mod);
+    }
+    ntt<mod, root>(first_values, true);
+    return first_values;
+  }
+  // first_length + second_length <= ntt_max_length
+  static void mul_ntt(limb* result, const limb* first, size_t first_length,
+                      const limb* second, size_t second_length) {
+    size_t length = 1;
+    while (length < first_length + second_length) length <<= 1;
+    using Convolution = std::vector<uint32_t> (*)(const limb*, size_t, const limb*, size_t, size_t);
+    constexpr Convolution convolutions[3] = {&ntt_convolution<ntt_primes[0], ntt_roots[0]>,
+                                             &ntt_convolution<ntt_primes[1], ntt_roots[1]>,
+                                             &ntt_convolution<ntt_primes[2], ntt_roots[2]>};
+    std::vector<uint32_t> residues[3];
+    // one prime per thread, the threads left over go to the butterflies
+    parallel_for(3, threads_for(second_length), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        residues[i] = convolutions[i](first, first_length, second, second_length, length);
+      }
+    });
+    // Garner's reconstruction
+    constexpr uint64_t first_prime = ntt_primes[0];
+    constexpr uint64_t second_prime = ntt_primes[1];
+    constexpr uint64_t third_prime = ntt_primes[2];
+    constexpr uint64_t first_inverse = power_mod(first_prime, second_prime - 2, second_prime);
+    constexpr uint64_t first_second_inverse = power_mod(first_prime * second_prime % third_prime, third_prime - 2,
+                                                        third_prime);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < first_length + second_length; ++i) {
+      uint64_t x1 = residues[0][i];
+      uint64_t x2 = (residues[1][i] + second_prime - x1 % second_prime) * first_inverse % second_prime;
+      uint64_t x3 = (residues[2][i] + 2 * third_prime - (x1 + x2 * first_prime) % third_prime) % third_prime
+                    * first_second_inverse % third_prime;
+      carry += x1 + x2 * first_prime + (unsigned __int128) (x3) * (first_prime * second_prime);
+      result[i] = limb(carry);
+      carry >>= limb_bits;
+    }
+  }
+  // result has first_length + second_length blocks
+  static void multiply_unsigned(limb* result, const limb* first, size_t first_length,
+                                const limb* second, size_t second_length) {
+    if (first_length < second_length) {
+      std::swap(first, second);
+      std::swap(first_length, second_length);
+    }
+    using Operation = BigIntegerStats::Operation;
+    if (second_length < std::max<size_t>(karatsuba_threshold, 4)) {
+      BigIntegerStats::record(Operation::schoolbook, second_length, first_length + second_length);
+      std::fill(result, result + first_length + second_length, 0);
+      mul_schoolbook(result, first, first_length, second, second_length);
+    } else if (second_length >= ntt_threshold && first_length + second_length <= ntt_max_length) {
+      BigIntegerStats::record(Operation::ntt, second_length, first_length + second_length);
+      mul_ntt(result, first, first_length, second, second_length);
+    } else if (first_length >= 2 * second_length) {
+      // unbalanced operands: cut the longer one into pieces of the shorter one's length
+      BigIntegerStats::record(Operation::unbalanced, second_length, first_length + second_length);
+      std::fill(result, result + first_length + second_length, 0);
+      size_t threads = threads_for(second_length);
+      if (threads > 1) {
+        // products of the even pieces do not overlap and go straight into result, the odd ones into a second
+        // number that is added once at the end
+        size_t pieces = (first_length + second_length - 1) / second_length;
+        Limbs odd(first_length);
+        parallel_for(pieces, threads, [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            size_t offset = i * second_length;
+            size_t length = std::min(second_length, first_length - offset);
+            limb* target = i % 2 == 0 ? result + offset : odd.data() + offset - second_length;
+            multiply_unsigned(target, first + offset, length, second, second_length);
+          }
+        });
+        add_blocks(result + second_length, result + second_length, first_length, odd.data(), first_length);
+        return;
       }
+      Limbs piece(2 * second_length);
+      for (size_t offset = 0; offset < first_length; offset += second_length) {
+        size_t length = std::min(second_length, first_length - offset);
+        multiply_unsigned(piece.data(), first + offset, length, second, second_length);
+        add_blocks(result + offset, result + offset, first_length + second_length - offset,
+                   piece.data(), length + second_length);
+      }
+    } else if (second_length < toom3_threshold) {
+      BigIntegerStats::record(Operation::karatsuba, second_length, first_length + second_length);
+      mul_karatsuba(result, first, first_length, second, second_length);
+    } else {
+      BigIntegerStats::record(Operation::toom3, second_length, first_length + second_length);
+      mul_toom3(result, first, first_length, second, second_length);
+    }
+  }
+  // first[0..length) /= divisor, returns the remainder
+  static constexpr limb divide_blocks_small(limb* first, size_t length, limb divisor) {
+    wide remainder = 0;
+    for (size_t i = length; i-- > 0;) {
+      wide current = (remainder << limb_bits) | first[i];
+      first[i] = limb(current / divisor);
+      remainder = current % divisor;
+    }
+    return limb(remainder);
+  }
+  // exact division by a small number, sign is kept
+  limb divide_small(limb divisor) {
+    limb remainder = divide_blocks_small(blocks.data(), blocks_amount, divisor);
+    resize();
+    adduction();
+    return remainder;
+  }
+  // magnitude = magnitude * factor + addend
+  void multiply_add_small(limb factor, limb addend) {
+    limb carry = multiply_blocks_small(blocks.data(), blocks_amount, factor);
+    wide current = wide(blocks[0]) + addend;
+    blocks[0] = limb(current);
+    for (size_t i = 1; current >> limb_bits && i < size_t(blocks_amount); ++i) {
+      current = wide(blocks[i]) + 1;
+      blocks[i] = limb(current);
+    }
+    if (current >> limb_bits) ++carry;
+    if (carry != 0) {
+      blocks.push_back(carry);
+      ++blocks_amount;
     }
+  }
+  // limbs are always normalized, only zero has to get its sign back
+  void adduction() {
     if (blocks_amount == 1 && blocks[0] == 0) {
       is_positive = true;
     }
   }
   void resize() {
+    [[maybe_unused]] long long old_amount = blocks_amount;
     for (long long i = blocks_amount - 1; i > 0; --i) {
       if (blocks[i] == 0) {
         blocks.pop_back();
@@ -205,232 +1352,1389 @@ class BigInteger {
         i = 0;
       }
     }
+    if (old_amount != blocks_amount) {
+      BigIntegerStats::record(BigIntegerStats::Operation::trim, old_amount, old_amount - blocks_amount);
+    }
   }
   void sum_unsigned(const BigInteger& num) {
-    blocks.resize(std::max(blocks_amount, num.blocks_amount) + 1);
-    for (long long i = 0; i < num.blocks_amount; ++i) {
-      blocks[i] += num.blocks[i];
-      if (blocks[i] >= base) {
-        blocks[i + 1]++;
-        blocks[i] -= base;
-      }
-    }
+    // num may be this number, its blocks must not move while they are added
+    blocks.reserve(std::max(blocks_amount, num.blocks_amount) + 1);
+    sum_unsigned(num.blocks.data(), num.blocks_amount);
+  }
+  void sum_unsigned(const limb* num, size_t length) {
+    size_t new_length = std::max<size_t>(blocks_amount, length);
+    blocks.resize(new_length + 1);
+    blocks[new_length] = add_blocks(blocks.data(), blocks.data(), new_length, num, length);
     is_positive = true;
-    blocks_amount = std::max(blocks_amount, num.blocks_amount) + 1;
+    blocks_amount = new_length + 1;
   }
   void subtract_unsigned(const BigInteger& num) {
-    blocks.resize(std::max(blocks_amount, num.blocks_amount));
-    for (long long i = 0; i < num.blocks_amount; ++i) {
-      blocks[i] -= num.blocks[i];
-      if (blocks[i] < 0 && i != num.blocks_amount - 1) {
-        blocks[i] += base;
-        blocks[i + 1]--;
+    subtract_unsigned(num.blocks.data(), num.blocks_amount);
+  }
+  // length is taken without leading zero blocks
+  void subtract_unsigned(const limb* num, size_t length) {
+    if (compare_blocks(blocks.data(), blocks_amount, num, length) >= 0) {
+      subtract_blocks(blocks.data(), blocks_amount, num, length);
+      is_positive = true;
+    } else {
+      Limbs difference(num, num + length);
+      subtract_blocks(difference.data(), length, blocks.data(), blocks_amount);
+      blocks = std::move(difference);
+      blocks_amount = length;
+      is_positive = false;
+    }
+  }
+  // *this = the sum of the terms: the added and the subtracted ones go into one accumulator each, small products
+  // are multiplied straight into it; the operands may include this number
+  void assign_terms(const FusedTerm* terms, size_t count) {
+    size_t length = 1;
+    for (size_t i = 0; i < count; ++i) {
+      const FusedTerm& term = terms[i];
+      length = std::max<size_t>(length, term.first->blocks_amount + (term.second ? term.second->blocks_amount : 0));
+    }
+    // fewer than 2^32 terms: one more block takes the carries
+    ++length;
+    Limbs sums[2];
+    Limbs product;
+    for (size_t i = 0; i < count; ++i) {
+      const FusedTerm& term = terms[i];
+      const BigInteger& first = *term.first;
+      bool negative = term.negative != !first.is_positive;
+      if (term.second) negative = negative != !term.second->is_positive;
+      Limbs& sum = sums[negative];
+      if (sum.empty()) sum.resize(length);
+      if (!term.second) {
+        add_blocks(sum.data(), sum.data(), length, first.blocks.data(), first.blocks_amount);
+        continue;
+      }
+      const BigInteger* longer = term.first;
+      const BigInteger* shorter = term.second;
+      if (longer->blocks_amount < shorter->blocks_amount) std::swap(longer, shorter);
+      size_t longer_length = longer->blocks_amount;
+      size_t shorter_length = shorter->blocks_amount;
+      if (shorter_length < std::max<size_t>(karatsuba_threshold, 4)) {
+        BigIntegerStats::record(BigIntegerStats::Operation::schoolbook, shorter_length, longer_length + shorter_length);
+        // rows of the shorter operand, so that the carry of a row is propagated once per block of it
+        mul_add_schoolbook(sum.data(), length, shorter->blocks.data(), shorter_length,
+                           longer->blocks.data(), longer_length);
+      } else {
+        product.clear();
+        product.resize(longer_length + shorter_length);
+        multiply_unsigned(product.data(), longer->blocks.data(), longer_length, shorter->blocks.data(), shorter_length);
+        add_blocks(sum.data(), sum.data(), length, product.data(), product.size());
       }
     }
-    is_positive = true;
-    blocks_amount = std::max(blocks_amount, num.blocks_amount);
-    if (blocks[blocks_amount - 1] < 0) {
-      is_positive = false;
-      blocks[blocks_amount - 1] *= -1;
-      for (long long i = blocks_amount - 2; i >= 0; --i) {
-        blocks[i] = base - blocks[i];
-        blocks[i + 1]--;
-      }
-    }
-  }
-  std::vector<long long> divide_unsigned(const BigInteger& num) {
-    std::vector<long long> carry(num.blocks_amount);
-    std::vector<long long> result(blocks_amount);
-    std::vector<long long> count_arr;
-    long long upper_bound = 0;
-    long long bottom_bound = 0;
-    long long current_bound = 0;
-    for (long long i = 0; i < blocks_amount; ++i) {
-      carry.insert(carry.begin(), blocks[blocks_amount - 1 - i]);
-      carry[carry.blocks_amount() - 2] += carry[carry.blocks_amount() - 1] * base;
-      carry.pop_back();
-      upper_bound = carry[carry.blocks_amount() - 1] / num.blocks[num.blocks_amount - 1];
-      bottom_bound = carry[carry.blocks_amount() - 1] / (num.blocks[num.blocks_amount - 1] + 1);
-      current_bound = (upper_bound + bottom_bound) / 2;
-      while (upper_bound != bottom_bound) {
-        count_arr = carry;
-        for (long long j = 0; j < num.blocks_amount; ++j) {
-          count_arr[j] -= current_bound * num.blocks[j];
-          if (count_arr[j] < 0) {
-            if (j != num.blocks_amount - 1) {
-              count_arr[j + 1] -= std::abs(count_arr[j]) / base;
-              if (std::abs(count_arr[j]) % base) count_arr[j + 1]--;
-              count_arr[j] %= base;
-              count_arr[j] += base;
-            }
-          }
+    bool negative = false;
+    if (sums[0].empty()) {
+      std::swap(sums[0], sums[1]);
+      negative = true;
+      if (sums[0].empty()) sums[0].resize(length);
+    } else if (!sums[1].empty()) {
+      if (compare_blocks(sums[0].data(), length, sums[1].data(), length) < 0) {
+        std::swap(sums[0], sums[1]);
+        negative = true;
+      }
+      subtract_blocks(sums[0].data(), length, sums[1].data(), length);
+    }
+    blocks = std::move(sums[0]);
+    blocks_amount = length;
+    is_positive = !negative;
+    resize();
+    adduction();
+  }
+  // adds num_1 * num_2 if add is set, subtracts it otherwise
+  BigInteger& add_product(const BigInteger& num_1, const BigInteger& num_2, bool add) {
+    Limbs product(num_1.blocks_amount + num_2.blocks_amount);
+    multiply_unsigned(product.data(), num_1.blocks.data(), num_1.blocks_amount,
+                      num_2.blocks.data(), num_2.blocks_amount);
+    size_t length = product.size();
+    while (length > 1 && product[length - 1] == 0) --length;
+    if (blocks_amount == 1 && blocks[0] == 0) {
+      // nothing to add to: the product becomes the number
+      blocks = std::move(product);
+      blocks_amount = blocks.size();
+      is_positive = add;
+      resize();
+      adduction();
+      return *this;
+    }
+    bool old_sign = is_positive;
+    if (is_positive == add) {
+      sum_unsigned(product.data(), length);
+      is_positive = old_sign;
+    } else {
+      subtract_unsigned(product.data(), length);
+      if (!old_sign) {
+        is_positive = !is_positive;
+      }
+    }
+    resize();
+    adduction();
+    return *this;
+  }
+  // first[0..length) *= factor, returns carry
+  static constexpr limb multiply_blocks_small(limb* first, size_t length, limb factor) {
+    wide carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+      wide current = wide(first[i]) * factor + carry;
+      first[i] = limb(current);
+      carry = current >> limb_bits;
+    }
+    return limb(carry);
+  }
+  // result[0..length) = source << bits (bits < limb_bits), result may alias source; returns the bits shifted out
+  static constexpr limb shift_blocks_left(limb* result, const limb* source, size_t length, int bits) {
+    if (bits == 0) {
+      std::copy(source, source + length, result);
+      return 0;
+    }
+    limb carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+      limb current = source[i];
+      result[i] = (current << bits) | carry;
+      carry = current >> (limb_bits - bits);
+    }
+    return carry;
+  }
+  // first[0..length) >>= bits (bits < limb_bits)
+  static constexpr void shift_blocks_right(limb* first, size_t length, int bits) {
+    if (bits == 0) return;
+    for (size_t i = 0; i < length; ++i) {
+      first[i] = (first[i] >> bits) | (i + 1 < length ? first[i + 1] << (limb_bits - bits) : 0);
+    }
+  }
+  // length blocks of the number in two's complement, length is more than blocks_amount
+  void to_complement(limb* result, size_t length) const {
+    std::copy(blocks.begin(), blocks.begin() + blocks_amount, result);
+    std::fill(result + blocks_amount, result + length, 0);
+    if (!is_positive) negate_complement(result, length);
+  }
+  // -x = ~x + 1 in place
+  static void negate_complement(limb* first, size_t length) {
+    limb carry = 1;
+    for (size_t i = 0; i < length; ++i) {
+      first[i] = ~first[i] + carry;
+      carry &= first[i] == 0;
+    }
+  }
+  // one block more than the longer operand leaves room for the sign bit
+  template<typename Operation>
+  BigInteger& bitwise(const BigInteger& num, Operation operation) {
+    size_t length = size_t(std::max(blocks_amount, num.blocks_amount)) + 1;
+    Limbs result(length);
+    Limbs other(length);
+    to_complement(result.data(), length);
+    num.to_complement(other.data(), length);
+    for (size_t i = 0; i < length; ++i) result[i] = operation(result[i], other[i]);
+    bool is_negative = result[length - 1] >> (limb_bits - 1);
+    if (is_negative) negate_complement(result.data(), length);
+    blocks = std::move(result);
+    blocks_amount = length;
+    is_positive = !is_negative;
+    resize();
+    adduction();
+    return *this;
+  }
+  // multiplies the magnitude by 2^bits (bits < limb_bits)
+  void shift_bits_left(int bits) {
+    limb carry = shift_blocks_left(blocks.data(), blocks.data(), blocks_amount, bits);
+    if (carry != 0) {
+      blocks.push_back(carry);
+      ++blocks_amount;
+    }
+  }
+  // multiplies by base^count
+  void shift_blocks(size_t count) {
+    if (blocks_amount == 1 && blocks[0] == 0) return;
+    blocks.insert(blocks.begin(), count, 0);
+    blocks_amount += count;
+  }
+  // divides by base^count, rounding towards zero
+  void truncate_blocks(size_t count) {
+    if (count >= size_t(blocks_amount)) {
+      blocks = {0};
+      blocks_amount = 1;
+      is_positive = true;
+      return;
+    }
+    blocks.erase(blocks.begin(), blocks.begin() + count);
+    blocks_amount -= count;
+  }
+  static BigInteger power_of_base(size_t exponent) {
+    BigInteger result = 1;
+    result.shift_blocks(exponent);
+    return result;
+  }
+  // floor(base^(2 * length) / divisor) for a divisor of length blocks with the highest bit set
+  static BigInteger reciprocal(const BigInteger& divisor) {
+    size_t length = divisor.blocks_amount;
+    if (length < std::max<size_t>(newton_threshold / 2, 8)) {
+      BigInteger result = power_of_base(2 * length);
+      result.divide_unsigned(divisor);
+      result.resize();
+      return result;
+    }
+    // half of the divisor gives half of the digits, one Newton step doubles them
+    size_t half = length / 2 + 2;
+    BigInteger top = divisor;
+    top.truncate_blocks(length - half);
+    BigInteger estimate = reciprocal(top);
+    estimate.shift_blocks(length - half);
+    BigInteger error = power_of_base(2 * length);
+    BigInteger product = divisor;
+    product *= estimate;
+    error -= product;
+    BigInteger correction = error;
+    correction *= estimate;
+    correction.truncate_blocks(2 * length);
+    estimate += correction;
+    // now the estimate is off by a few units at most
+    product = divisor;
+    product *= correction;
+    error -= product;
+    while (error < 0) {
+      error += divisor;
+      --estimate;
+    }
+    while (!(error < divisor)) {
+      error -= divisor;
+      ++estimate;
+    }
+    return estimate;
+  }
+  // same contract as divide_unsigned, the dividend is consumed in pieces of the divisor's length
+  Limbs divide_newton(const BigInteger& num) {
+    int shift = std::countl_zero(num.blocks[num.blocks_amount - 1]);
+    BigInteger divisor = num.abs();
+    divisor.shift_bits_left(shift);
+    return divide_newton(divisor, reciprocal(divisor), shift);
+  }
+  // the divisor is already shifted left by shift bits, inverse is its reciprocal
+  Limbs divide_newton(const BigInteger& divisor, const BigInteger& inverse, int shift) {
+    BigInteger dividend = abs();
+    dividend.shift_bits_left(shift);
+    size_t length = divisor.blocks_amount;
+    size_t pieces = (dividend.blocks_amount + length - 1) / length;
+    Limbs quotient(pieces * length);
+    BigInteger remainder = 0;
+    for (size_t piece = pieces; piece-- > 0;) {
+      size_t begin = piece * length;
+      size_t end = std::min<size_t>(dividend.blocks_amount, begin + length);
+      BigInteger current = remainder;
+      current.shift_blocks(length);
+      current += from_blocks(dividend.blocks.data() + begin, end - begin);
+      // the low blocks of current change the estimate by less than one
+      BigInteger digit = current;
+      digit.truncate_blocks(length - 1);
+      digit *= inverse;
+      digit.truncate_blocks(length + 1);
+      BigInteger product = digit;
+      product *= divisor;
+      remainder = current;
+      remainder -= product;
+      while (!(remainder < divisor)) {
+        remainder -= divisor;
+        ++digit;
+      }
+      std::copy(digit.blocks.begin(), digit.blocks.begin() + digit.blocks_amount, quotient.begin() + begin);
+    }
+    shift_blocks_right(remainder.blocks.data(), remainder.blocks_amount, shift);
+    remainder.resize();
+    blocks = std::move(quotient);
+    blocks_amount = blocks.size();
+    resize();
+    return Limbs(remainder.blocks.begin(), remainder.blocks.begin() + remainder.blocks_amount);
+  }
+  // the decimal caches have an entry per level, far more than any number needs
+  static constexpr size_t decimal_levels = 64;
+
+  // 10^(pr * 2^level), computed once per level; threads share the table, an entry is published only once it is built
+  static const BigInteger& decimal_power(size_t level) {
+    static std::atomic<const BigInteger*> published[decimal_levels];
+    if (const BigInteger* power = published[level].load(std::memory_order_acquire)) return *power;
+    static std::mutex mutex;
+    static std::deque<BigInteger> powers = {BigInteger(decimal_base)};
+    std::lock_guard<std::mutex> lock(mutex);
+    while (powers.size() <= level) {
+      BigInteger square = powers.back();
+      square *= powers.back();
+      powers.push_back(std::move(square));
+    }
+    published[level].store(&powers[level], std::memory_order_release);
+    return powers[level];
+  }
+  // value /= 10^(pr * 2^level), returns the remainder; Newton division reuses the reciprocal of each power
+  static Limbs divide_decimal_power(BigInteger& value, size_t level) {
+    const BigInteger& power = decimal_power(level);
+    Limbs remainder;
+    if (size_t(power.blocks_amount) < std::max<size_t>(newton_threshold, 8)) {
+      remainder = value.divide_unsigned(power);
+    } else {
+      // normalized powers and their reciprocals, built under the lock and published like the powers
+      using Reciprocal = std::pair<BigInteger, BigInteger>;
+      static std::atomic<const Reciprocal*> published[decimal_levels];
+      int shift = std::countl_zero(power.blocks[power.blocks_amount - 1]);
+      const Reciprocal* entry = published[level].load(std::memory_order_acquire);
+      if (!entry) {
+        static std::mutex mutex;
+        static std::deque<Reciprocal> reciprocals;
+        std::lock_guard<std::mutex> lock(mutex);
+        entry = published[level].load(std::memory_order_relaxed);
+        if (!entry) {
+          BigInteger divisor = power;
+          divisor.shift_bits_left(shift);
+          BigInteger inverse = reciprocal(divisor);
+          entry = &reciprocals.emplace_back(std::move(divisor), std::move(inverse));
+          published[level].store(entry, std::memory_order_release);
         }
-        if (count_arr[num.blocks_amount - 1] < 0) {
-          if (upper_bound - bottom_bound == 1) upper_bound = bottom_bound;
-          else {
-            upper_bound = current_bound;
-            current_bound = (bottom_bound + upper_bound) / 2;
-          }
+      }
+      remainder = value.divide_newton(entry->first, entry->second, shift);
+    }
+    value.resize();
+    return remainder;
+  }
+  // pr = 9 digits: the last 8 of them are combined inside one 64-bit word, in pairs, fours and then all eight
+  static limb parse_nine_digits(const char* digits) {
+    uint64_t word = 0;
+    for (int i = 0; i < 8; ++i) word |= uint64_t(uint8_t(digits[i + 1])) << (8 * i);
+    word = (word & 0x0F0F0F0F0F0F0F0F) * (10 * 256 + 1) >> 8;
+    word = (word & 0x00FF00FF00FF00FF) * (100 * 65536 + 1) >> 16;
+    word = (word & 0x0000FFFF0000FFFF) * (10000 * (uint64_t(1) << 32) + 1) >> 32;
+    return limb(digits[0] - '0') * 100'000'000 + limb(word);
+  }
+  // magnitude of a string of decimal digits
+  static BigInteger parse_decimal(const char* digits, size_t length) {
+    if (length <= pr * std::max<size_t>(decimal_threshold, 1)) {
+      BigInteger result = 0;
+      result.blocks.reserve(length / pr + 1);
+      // the first chunk is shorter so that all the following ones have pr digits
+      size_t chunk_length = length % pr == 0 ? pr : length % pr;
+      for (size_t i = 0; i < length; i += chunk_length, chunk_length = pr) {
+        limb chunk = 0;
+        if (chunk_length == pr) {
+          chunk = parse_nine_digits(digits + i);
         } else {
-          if (upper_bound - bottom_bound == 1) {
-            if (current_bound == upper_bound) bottom_bound = upper_bound;
-            else current_bound = upper_bound;
-          } else {
-            bottom_bound = current_bound;
-            current_bound = (bottom_bound + upper_bound) / 2;
+          for (size_t j = i; j < i + chunk_length; ++j) {
+            chunk = chunk * 10 + limb(digits[j] - '0');
           }
         }
+        result.multiply_add_small(i == 0 ? 1 : decimal_base, chunk);
       }
-      result[i] = bottom_bound;
-      for (long long j = 0; j < num.blocks_amount; ++j) {
-        carry[j] -= bottom_bound * num.blocks[j];
-        if (carry[j] < 0) {
-          carry[j + 1] -= std::abs(carry[j]) / base;
-          if (std::abs(carry[j]) % base != 0) carry[j + 1]--;
-          carry[j] %= base;
-          if (carry[j] < 0) carry[j] += base;
-        }
+      return result;
+    }
+    // the low part takes the largest cached power of 10 below the length
+    size_t level = 0;
+    while ((size_t(pr) << (level + 1)) < length) ++level;
+    size_t low_length = size_t(pr) << level;
+    BigInteger result = parse_decimal(digits, length - low_length);
+    result *= decimal_power(level);
+    result += parse_decimal(digits + length - low_length, low_length);
+    return result;
+  }
+  // digits are read from a stream in chunks of pr * 2^stream_level; a chunk of level l and the equally long number
+  // before it merge into one of level l + 1, like the carries of a binary counter, so the multiplications stay
+  // balanced and no more than a chunk of digits is ever held as text
+  static constexpr size_t stream_level = 9;
+  static bool read_decimal(std::streambuf& buffer, BigInteger& result) {
+    using traits = std::streambuf::traits_type;
+    std::array<char, size_t(pr) << stream_level> chunk;
+    std::vector<std::pair<BigInteger, size_t>> parts;
+    size_t length = 0;
+    bool is_empty = true;
+    for (int c = buffer.sgetc(); !traits::eq_int_type(c, traits::eof()); c = buffer.snextc()) {
+      if (c < '0' || c > '9') break;
+      chunk[length++] = char(c);
+      is_empty = false;
+      if (length < chunk.size()) continue;
+      parts.emplace_back(parse_decimal(chunk.data(), length), stream_level);
+      length = 0;
+      while (parts.size() > 1 && parts.back().second == parts[parts.size() - 2].second) {
+        auto [low, level] = std::move(parts.back());
+        parts.pop_back();
+        parts.back().first *= decimal_power(level);
+        parts.back().first += low;
+        ++parts.back().second;
       }
     }
-    std::reverse(result.begin(), result.end());
-    blocks = result;
-    blocks_amount = result.blocks_amount();
-    return carry;
+    // the parts are added from the least significant one, so that each is multiplied by a power of 10
+    // shorter than itself
+    result = length > 0 ? parse_decimal(chunk.data(), length) : 0;
+    BigInteger scale = power(decimal_base, length / pr);
+    scale *= power(10, length % pr);
+    while (!parts.empty()) {
+      auto [part, level] = std::move(parts.back());
+      parts.pop_back();
+      result.add_mul(part, scale);
+      if (!parts.empty()) scale *= decimal_power(level);
+    }
+    return !is_empty;
+  }
+  // appends the digits of a small magnitude, padded with zeros up to width
+  static void append_decimal_small(std::string& output, BigInteger value, size_t width) {
+    Limbs chunks;
+    size_t length = value.blocks_amount;
+    while (length > 1 || value.blocks[0] != 0) {
+      chunks.push_back(divide_blocks_small(value.blocks.data(), length, decimal_base));
+      while (length > 1 && value.blocks[length - 1] == 0) --length;
+    }
+    size_t digits = 0;
+    if (!chunks.empty()) {
+      digits = (chunks.size() - 1) * pr;
+      for (limb top = chunks.back(); top != 0; top /= 10) ++digits;
+    }
+    digits = std::max(digits, width);
+    output.resize(output.size() + digits);
+    char* end = output.data() + output.size();
+    char* position = end;
+    for (limb chunk : chunks) {
+      for (int i = 0; i < pr && position != end - digits; ++i) {
+        *--position = char('0' + chunk % 10);
+        chunk /= 10;
+      }
+    }
+    std::fill(end - digits, position, '0');
+  }
+  // appends exactly pr * 2^level digits of a magnitude below 10^(pr * 2^level)
+  static void append_decimal_padded(std::string& output, BigInteger value, size_t level) {
+    if (level == 0 || size_t(value.blocks_amount) < decimal_threshold) {
+      append_decimal_small(output, std::move(value), size_t(pr) << level);
+      return;
+    }
+    Limbs remainder = divide_decimal_power(value, level - 1);
+    append_decimal_padded(output, std::move(value), level - 1);
+    append_decimal_padded(output, from_blocks(remainder.data(), remainder.size()), level - 1);
+  }
+  // appends the digits of a magnitude: the high half goes on recursively, the low half is padded
+  static void append_decimal(std::string& output, BigInteger value) {
+    if (size_t(value.blocks_amount) < std::max<size_t>(decimal_threshold, 2)) {
+      append_decimal_small(output, std::move(value), 1);
+      return;
+    }
+    size_t level = 0;
+    while (2 * decimal_power(level + 1).blocks_amount <= value.blocks_amount) ++level;
+    Limbs remainder = divide_decimal_power(value, level);
+    append_decimal(output, std::move(value));
+    append_decimal_padded(output, from_blocks(remainder.data(), remainder.size()), level);
+  }
+  // result[0..length) = first * factor_1 - second * factor_2, the difference must be in [0, base^length)
+  static void combine_blocks(limb* result, size_t length, const limb* first, size_t first_length, limb factor_1,
+                             const limb* second, size_t second_length, limb factor_2) {
+    wide plus_carry = 0;
+    wide minus_carry = 0;
+    wide borrow = 0;
+    for (size_t i = 0; i < length; ++i) {
+      wide plus = (i < first_length ? wide(first[i]) * factor_1 : 0) + plus_carry;
+      wide minus = (i < second_length ? wide(second[i]) * factor_2 : 0) + minus_carry;
+      plus_carry = plus >> limb_bits;
+      minus_carry = minus >> limb_bits;
+      wide current = wide(limb(plus)) - limb(minus) - borrow;
+      result[i] = limb(current);
+      borrow = (current >> limb_bits) & 1;
+    }
+  }
+  static std::vector<size_t> primes_up_to(size_t n) {
+    std::vector<bool> is_composite(n + 1);
+    std::vector<size_t> primes;
+    for (size_t i = 2; i <= n; ++i) {
+      if (is_composite[i]) continue;
+      primes.push_back(i);
+      if (i > n / i) continue;
+      for (size_t j = i * i; j <= n; j += i) is_composite[j] = true;
+    }
+    return primes;
+  }
+  // the exponent of prime in n!, by Legendre's formula
+  static size_t factorial_exponent(size_t n, size_t prime) {
+    size_t exponent = 0;
+    for (; n > 0; n /= prime) exponent += n / prime;
+    return exponent;
+  }
+  // the product of primes[i]^exponents[i]: the bits of the exponents are taken from the highest, squaring the
+  // result and multiplying it by the product tree of the primes with the current bit set; 2 is a shift
+  static BigInteger from_prime_exponents(const std::vector<size_t>& primes, const std::vector<size_t>& exponents) {
+    size_t two = 0;
+    size_t highest = 0;
+    for (size_t i = 0; i < primes.size(); ++i) {
+      if (primes[i] == 2) {
+        two = exponents[i];
+      } else {
+        highest = std::max(highest, exponents[i]);
+      }
+    }
+    BigInteger result = 1;
+    std::vector<long long> factors;
+    for (int bit = std::bit_width(highest) - 1; bit >= 0; --bit) {
+      factors.clear();
+      for (size_t i = 0; i < primes.size(); ++i) {
+        if (primes[i] != 2 && (exponents[i] >> bit & 1)) factors.push_back((long long) primes[i]);
+      }
+      result *= result;
+      result *= product(factors.begin(), factors.end());
+    }
+    result <<= two;
+    return result;
+  }
+  static BigInteger power(BigInteger base, size_t exponent) {
+    BigInteger result = 1;
+    for (; exponent > 0; exponent /= 2) {
+      if (exponent % 2 == 1) result *= base;
+      if (exponent > 1) base *= base;
+    }
+    return result;
+  }
+  static void store_little_endian(std::byte* target, limb value) {
+    for (size_t i = 0; i < sizeof(limb); ++i) target[i] = std::byte(value >> (8 * i));
+  }
+  static limb load_little_endian(const std::byte* source) {
+    limb value = 0;
+    for (size_t i = 0; i < sizeof(limb); ++i) value |= limb(source[i]) << (8 * i);
+    return value;
+  }
+  // checks the header of a record and returns its number of blocks
+  static size_t serial_length(std::span<const std::byte> input) {
+    if (input.size() < serial_header_size || input[0] != serial_version || input[1] > std::byte{1} ||
+        input[2] != std::byte{0} || input[3] != std::byte{0}) {
+      throw std::invalid_argument("BigInteger::deserialize: bad header");
+    }
+    size_t length = load_little_endian(input.data() + 4);
+    if (length == 0 || (input.size() - serial_header_size) / sizeof(limb) < length) {
+      throw std::invalid_argument("BigInteger::deserialize: bad length");
+    }
+    return length;
+  }
+  // the remainder of the magnitude by a single block, without changing the number
+  limb remainder_small(limb divisor) const {
+    wide remainder = 0;
+    for (long long i = blocks_amount - 1; i >= 0; --i) remainder = (remainder << limb_bits | blocks[i]) % divisor;
+    return limb(remainder);
+  }
+  template<limb Divisor>
+  static constexpr std::array<bool, Divisor> square_residues = [] {
+    std::array<bool, Divisor> result{};
+    for (wide i = 0; i < Divisor; ++i) result[i * i % Divisor] = true;
+    return result;
+  }();
+  // one division by the product of the moduli below feeds all the residue tests
+  static constexpr limb residue_modulus = 63 * 65 * 11 * 17 * 19 * 23;
+  // the 62 bits of the magnitude starting from bit shift
+  uint64_t bits_from(size_t shift) const {
+    unsigned __int128 window = 0;
+    size_t index = shift / limb_bits;
+    for (size_t i = 3; i-- > 0;) {
+      window <<= limb_bits;
+      if (index + i < size_t(blocks_amount)) window |= blocks[index + i];
+    }
+    return uint64_t(window >> (shift % limb_bits)) & ((uint64_t(1) << 62) - 1);
+  }
+  // Lehmer's algorithm: the leading bits of both numbers predict several Euclidean steps at once
+  static BigInteger gcd_unsigned(BigInteger first, BigInteger second) {
+    if (first < second) std::swap(first, second);
+    BigIntegerStats::record(BigIntegerStats::Operation::gcd, first.blocks_amount,
+                            first.blocks_amount + second.blocks_amount);
+    BigInteger next_first;
+    BigInteger next_second;
+    while (second.blocks_amount > 2) {
+      size_t shift = size_t(first.blocks_amount) * limb_bits -
+                     std::countl_zero(first.blocks[first.blocks_amount - 1]) - 62;
+      long long x = first.bits_from(shift);
+      long long y = second.bits_from(shift);
+      // the quotients are right as long as the cofactors keep the remainders apart
+      long long a = 1, b = 0, c = 0, d = 1;
+      int steps = 0;
+      for (;; ++steps) {
+        if (y - c == 0) break;
+        long long quotient = (x + (a - 1)) / (y - c);
+        long long s = b + quotient * d;
+        long long t = x - quotient * y;
+        if (s > t) break;
+        x = y;
+        y = t;
+        t = a + quotient * c;
+        a = d;
+        b = c;
+        c = s;
+        d = t;
+      }
+      if (steps == 0) {
+        first %= second;
+        std::swap(first, second);
+        continue;
+      }
+      size_t length = first.blocks_amount;
+      next_first.blocks.resize(length);
+      next_second.blocks.resize(length);
+      const limb* first_blocks = first.blocks.data();
+      const limb* second_blocks = second.blocks.data();
+      size_t first_length = first.blocks_amount;
+      size_t second_length = second.blocks_amount;
+      if (steps % 2 == 1) {
+        // first, second = a * second - b * first, d * first - c * second
+        combine_blocks(next_first.blocks.data(), length, second_blocks, second_length, limb(a),
+                       first_blocks, first_length, limb(b));
+        combine_blocks(next_second.blocks.data(), length, first_blocks, first_length, limb(d),
+                       second_blocks, second_length, limb(c));
+      } else {
+        // first, second = a * first - b * second, d * second - c * first
+        combine_blocks(next_first.blocks.data(), length, first_blocks, first_length, limb(a),
+                       second_blocks, second_length, limb(b));
+        combine_blocks(next_second.blocks.data(), length, second_blocks, second_length, limb(d),
+                       first_blocks, first_length, limb(c));
+      }
+      next_first.blocks_amount = length;
+      next_second.blocks_amount = length;
+      next_first.resize();
+      next_second.resize();
+      std::swap(first, next_first);
+      std::swap(second, next_second);
+    }
+    // the rest fits into 64 bits
+    if (!second) return first;
+    first %= second;
+    uint64_t result = std::gcd(uint64_t(static_cast<long long>(first)), uint64_t(static_cast<long long>(second)));
+    limb result_blocks[2] = {limb(result), limb(result >> limb_bits)};
+    return from_blocks(result_blocks, 2);
+  }
+  // Knuth's algorithm D: quotient goes to blocks, the remainder is returned
+  Limbs divide_unsigned(const BigInteger& num) {
+    size_t divisor_length = num.blocks_amount;
+    if (divisor_length >= std::max<size_t>(newton_threshold, 8) &&
+        size_t(blocks_amount) >= divisor_length + newton_threshold) {
+      BigIntegerStats::record(BigIntegerStats::Operation::newton_division, divisor_length,
+                              blocks_amount + divisor_length);
+      return divide_newton(num);
+    }
+    BigIntegerStats::record(BigIntegerStats::Operation::division, divisor_length, blocks_amount + divisor_length);
+    if (compare_blocks(blocks.data(), blocks_amount, num.blocks.data(), divisor_length) < 0) {
+      Limbs remainder = std::move(blocks);
+      blocks = {0};
+      blocks_amount = 1;
+      return remainder;
+    }
+    if (divisor_length == 1) {
+      return {divide_blocks_small(blocks.data(), blocks_amount, num.blocks[0])};
+    }
+    // normalization: the highest bit of the divisor gets set
+    int shift = std::countl_zero(num.blocks[divisor_length - 1]);
+    Limbs divisor(divisor_length);
+    shift_blocks_left(divisor.data(), num.blocks.data(), divisor_length, shift);
+    Limbs remainder = std::move(blocks);
+    remainder.resize(blocks_amount + 1);
+    remainder[blocks_amount] = shift_blocks_left(remainder.data(), remainder.data(), blocks_amount, shift);
+    size_t quotient_length = blocks_amount - divisor_length + 1;
+    Limbs quotient(quotient_length);
+    wide divisor_top = divisor[divisor_length - 1];
+    wide divisor_next = divisor[divisor_length - 2];
+    for (size_t j = quotient_length; j-- > 0;) {
+      limb* window = remainder.data() + j;
+      wide current = (wide(window[divisor_length]) << limb_bits) | window[divisor_length - 1];
+      wide digit = current / divisor_top;
+      wide rest = current % divisor_top;
+      while (digit >= base || digit * divisor_next > ((rest << limb_bits) | window[divisor_length - 2])) {
+        --digit;
+        rest += divisor_top;
+        if (rest >= base) break;
+      }
+      // window -= digit * divisor
+      wide carry = 0;
+      wide borrow = 0;
+      for (size_t i = 0; i < divisor_length; ++i) {
+        wide product = digit * divisor[i] + carry;
+        carry = product >> limb_bits;
+        wide current_block = wide(window[i]) - limb(product) - borrow;
+        window[i] = limb(current_block);
+        borrow = (current_block >> limb_bits) & 1;
+      }
+      wide top = wide(window[divisor_length]) - carry - borrow;
+      window[divisor_length] = limb(top);
+      if (top >> limb_bits) {
+        // the estimate was one too big: add the divisor back
+        --digit;
+        window[divisor_length] += add_blocks(window, window, divisor_length, divisor.data(), divisor_length);
+      }
+      quotient[j] = limb(digit);
+    }
+    remainder.resize(divisor_length);
+    shift_blocks_right(remainder.data(), divisor_length, shift);
+    blocks = std::move(quotient);
+    blocks_amount = quotient_length;
+    return remainder;
   }
 };
 
+BigInteger operator-(BigInteger&& num) {
+  num.is_positive = !num.is_positive;
+  num.adduction();
+  return std::move(num);
+}
+BigInteger operator-(const BigInteger& num) {
+  return -BigInteger(num);
+}
+
+// an expiring operand lends its blocks to the result
 BigInteger operator+(const BigInteger& num_1, const BigInteger& num_2) {
   BigInteger copy = num_1;
   copy += num_2;
   return copy;
 }
+BigInteger operator+(BigInteger&& num_1, const BigInteger& num_2) {
+  num_1 += num_2;
+  return std::move(num_1);
+}
+BigInteger operator+(const BigInteger& num_1, BigInteger&& num_2) {
+  num_2 += num_1;
+  return std::move(num_2);
+}
+BigInteger operator+(BigInteger&& num_1, BigInteger&& num_2) {
+  num_1 += num_2;
+  return std::move(num_1);
+}
 BigInteger operator-(const BigInteger& num_1, const BigInteger& num_2) {
   BigInteger copy = num_1;
   copy -= num_2;
   return copy;
 }
+BigInteger operator-(BigInteger&& num_1, const BigInteger& num_2) {
+  num_1 -= num_2;
+  return std::move(num_1);
+}
+BigInteger operator-(const BigInteger& num_1, BigInteger&& num_2) {
+  num_2 -= num_1;
+  return -std::move(num_2);
+}
+BigInteger operator-(BigInteger&& num_1, BigInteger&& num_2) {
+  num_1 -= num_2;
+  return std::move(num_1);
+}
 BigInteger operator*(const BigInteger& num_1, const BigInteger& num_2) {
-  BigInteger copy = num_1;
-  copy *= num_2;
-  return copy;
+  BigInteger product;
+  product.add_mul(num_1, num_2);
+  return product;
+}
+BigInteger operator*(BigInteger&& num_1, const BigInteger& num_2) {
+  num_1 *= num_2;
+  return std::move(num_1);
+}
+BigInteger operator*(const BigInteger& num_1, BigInteger&& num_2) {
+  num_2 *= num_1;
+  return std::move(num_2);
+}
+BigInteger operator*(BigInteger&& num_1, BigInteger&& num_2) {
+  num_1 *= num_2;
+  return std::move(num_1);
 }
 BigInteger operator/(const BigInteger& num_1, const BigInteger& num_2) {
   BigInteger copy = num_1;
   copy /= num_2;
   return copy;
 }
+BigInteger operator/(BigInteger&& num_1, const BigInteger& num_2) {
+  num_1 /= num_2;
+  return std::move(num_1);
+}
 BigInteger operator%(const BigInteger& num_1, const BigInteger& num_2) {
   BigInteger copy = num_1;
   copy %= num_2;
   return copy;
 }
-BigInteger operator-(const BigInteger& num) {
-  BigInteger copy = num;
-  copy *= -1;
-  return copy;
+BigInteger operator%(BigInteger&& num_1, const BigInteger& num_2) {
+  num_1 %= num_2;
+  return std::move(num_1);
 }
 
-bool operator<(const BigInteger& num_1, const BigInteger& num_2) {
-  int result = 0;
-  // 0 - less
-  //1 - more
-  if (num_1.is_positive && !num_2.is_positive) {
-    return false;
-  } else if (!num_1.is_positive && num_2.is_positive) {
-    return true;
-  } else {
-    if (num_2.blocks_amount < num_1.blocks_amount) {
-      result = 1;
-    } else if (num_2.blocks_amount == num_1.blocks_amount) {
-      long long i = num_1.blocks_amount - 1;
-      while (num_1.blocks[i] == num_2.blocks[i] && i > 0) --i;
-      if (num_1.blocks[i] > num_2.blocks[i]) {
-        result = 1;
-      } else if (num_1.blocks[i] < num_2.blocks[i]) {
-        result = 0;
-      } else {
-        return false;
-      }
-    }
-    if (!num_1.is_positive) {
-      result += 1;
-      result %= 2;
-    }
-    return !result;
+// 123456789012345678901234567890_bi is parsed by the compiler, at run time its blocks are only copied;
+// floating-point literals like 1.5_bi or 1e3_bi are ill-formed
+template<char... Digits>
+  requires (is_integer_literal<Digits...>())
+BigInteger operator""_bi() {
+  static constexpr auto blocks = BigInteger::literal_blocks<Digits...>();
+  return BigInteger::from_blocks(blocks.data(), blocks.size());
+}
+
+BigInteger operator<<(BigInteger num, size_t shift) {
+  num <<= shift;
+  return num;
+}
+BigInteger operator>>(BigInteger num, size_t shift) {
+  num >>= shift;
+  return num;
+}
+BigInteger operator&(BigInteger num_1, const BigInteger& num_2) {
+  num_1 &= num_2;
+  return num_1;
+}
+BigInteger operator|(BigInteger num_1, const BigInteger& num_2) {
+  num_1 |= num_2;
+  return num_1;
+}
+BigInteger operator^(BigInteger num_1, const BigInteger& num_2) {
+  num_1 ^= num_2;
+  return num_1;
+}
+// ~x = -x - 1
+BigInteger operator~(BigInteger num) {
+  num = -std::move(num);
+  num -= 1;
+  return num;
+}
+
+BigInteger gcd(const BigInteger& num_1, const BigInteger& num_2) {
+  return BigInteger::gcd_unsigned(num_1.abs(), num_2.abs());
+}
+
+BigInteger BigInteger::factorial(size_t n) {
+  std::vector<size_t> primes = primes_up_to(n);
+  std::vector<size_t> exponents(primes.size());
+  for (size_t i = 0; i < primes.size(); ++i) exponents[i] = factorial_exponent(n, primes[i]);
+  return from_prime_exponents(primes, exponents);
+}
+
+// Kummer: the exponent of a prime in n! / (k! (n - k)!) is the difference of the factorial ones
+BigInteger BigInteger::binomial(size_t n, size_t k) {
+  if (k > n) return 0;
+  std::vector<size_t> primes = primes_up_to(n);
+  std::vector<size_t> exponents(primes.size());
+  for (size_t i = 0; i < primes.size(); ++i) {
+    exponents[i] = factorial_exponent(n, primes[i]) - factorial_exponent(k, primes[i]) -
+                   factorial_exponent(n - k, primes[i]);
   }
+  return from_prime_exponents(primes, exponents);
+}
 
+std::strong_ordering operator<=>(const BigInteger& num_1, const BigInteger& num_2) {
+  return num_1.compare(num_2) <=> 0;
+}
+bool operator<(const BigInteger& num_1, const BigInteger& num_2) {
+  return num_1.compare(num_2) < 0;
 }
 bool operator>(const BigInteger& num_1, const BigInteger& num_2) {
-  return num_2 < num_1;
+  return num_1.compare(num_2) > 0;
 }
 bool operator==(const BigInteger& num_1, const BigInteger& num_2) {
-  return !((num_2 < num_1) || (num_1 < num_2));
+  return num_1.compare(num_2) == 0;
 }
 bool operator!=(const BigInteger& num_1, const BigInteger& num_2) {
-  return !(num_1 == num_2);
+  return num_1.compare(num_2) != 0;
 }
 bool operator<=(const BigInteger& num_1, const BigInteger& num_2) {
-  return (num_1 < num_2) || (num_1 == num_2);
+  return num_1.compare(num_2) <= 0;
 }
 bool operator>=(const BigInteger& num_1, const BigInteger& num_2) {
-  return (num_1 > num_2) || (num_1 == num_2);
+  return num_1.compare(num_2) >= 0;
+}
+// precision doubling: every step takes the root of twice as many top bits from the previous one with a single
+// division (the algorithm of Python's math.isqrt); the first 26 bits come from a double
+BigInteger BigInteger::isqrt() const {
+  if (!is_positive) throw std::domain_error("BigInteger::isqrt: negative number");
+  size_t bits = bit_length();
+  if (bits <= 52) {
+    auto value = uint64_t(static_cast<long long>(BigInteger(*this)));
+    auto root = uint64_t(std::sqrt(double(value)));
+    while (root * root > value) --root;
+    while ((root + 1) * (root + 1) <= value) ++root;
+    return (long long) root;
+  }
+  size_t c = (bits - 1) / 2;
+  int step = std::bit_width(c) - 1;
+  while (step > 0 && (c >> (step - 1)) <= 25) --step;
+  size_t d = c >> step;
+  // invariant: (a - 1)^2 < (this >> 2 (c - d)) < (a + 1)^2
+  BigInteger a = (*this >> 2 * (c - d)).isqrt();
+  for (--step; step >= 0; --step) {
+    size_t e = d;
+    d = c >> step;
+    BigInteger correction = (*this >> (2 * c - e - d + 1)) / a;
+    a <<= d - e - 1;
+    a += correction;
+  }
+  if (a * a > *this) --a;
+  return a;
+}
+
+// Newton's iteration x = ((n - 1) x + this / x^(n - 1)) / n goes down to the root from a double estimate above it
+BigInteger BigInteger::iroot(size_t n) const {
+  if (n == 0) throw std::domain_error("BigInteger::iroot: zeroth root");
+  if (!is_positive) throw std::domain_error("BigInteger::iroot: negative number");
+  if (n == 1 || *this <= 1) return *this;
+  if (n == 2) return isqrt();
+  size_t bits = bit_length();
+  // the root is below 2^(bits / n)
+  if (n >= bits) return 1;
+  size_t drop = bits > 64 ? bits - 64 : 0;
+  auto top = uint64_t(static_cast<long long>(*this >> drop));
+  double logarithm = (std::log2(double(top)) + double(drop)) / double(n);
+  auto shift = size_t(std::max(0.0, std::floor(logarithm) - 52));
+  BigInteger root = (long long) std::ceil(std::exp2(logarithm - double(shift)) * (1 + 0x1p-20)) + 1;
+  root <<= shift;
+  while (true) {
+    BigInteger next = *this / power(root, n - 1);
+    next.add_mul(root, BigInteger((long long) n - 1));
+    next /= BigInteger((long long) n);
+    if (next >= root) return root;
+    root = std::move(next);
+  }
+}
+
+// squares leave few residues modulo 64, 63, 65, 11, 17, 19 and 23: together the tests let through
+// less than 1% of the non-squares before the root is taken
+bool BigInteger::is_perfect_square() const {
+  if (!is_positive) return false;
+  if (!square_residues<64>[blocks[0] % 64]) return false;
+  limb residue = remainder_small(residue_modulus);
+  if (!square_residues<63>[residue % 63] || !square_residues<65>[residue % 65] ||
+      !square_residues<11>[residue % 11] || !square_residues<17>[residue % 17] ||
+      !square_residues<19>[residue % 19] || !square_residues<23>[residue % 23]) {
+    return false;
+  }
+  BigInteger root = isqrt();
+  return root * root == *this;
 }
+
+// a^k with composite k is also a power with a prime exponent, so only those are tried; a number with 2^v as a
+// factor can only be a power with an exponent dividing v
+bool BigInteger::is_perfect_power() const {
+  if (*this <= 1) return sign() >= 0;
+  size_t bits = bit_length();
+  size_t twos = 0;
+  while (!(blocks[twos / limb_bits] >> (twos % limb_bits) & 1)) ++twos;
+  if (twos == 0 || twos % 2 == 0) {
+    if (is_perfect_square()) return true;
+  }
+  for (size_t prime : primes_up_to(bits)) {
+    if (prime == 2 || (twos > 0 && twos % prime != 0)) continue;
+    if (power(iroot(prime), prime) == *this) return true;
+  }
+  return false;
+}
+
 std::ostream& operator<<(std::ostream& output, const BigInteger& biggie) {
   output << biggie.toString();
   return output;
 }
+// an optional sign, then the digits are taken from the stream buffer in chunks, see read_decimal
 std::istream& operator>>(std::istream& input, BigInteger& biggie) {
   input.tie(nullptr);
-  biggie.clear();
-  std::string input_num;
-  input >> input_num;
-  biggie = BigInteger(input_num);
+  std::istream::sentry sentry(input);
+  if (!sentry) return input;
+  std::streambuf& buffer = *input.rdbuf();
+  int sign = buffer.sgetc();
+  bool is_negative = sign == '-';
+  bool has_sign = is_negative || sign == '+';
+  if (has_sign) buffer.sbumpc();
+  if (!BigInteger::read_decimal(buffer, biggie)) {
+    // a sign with no digits after it is left in the stream
+    if (has_sign) buffer.sputbackc(char(sign));
+    input.setstate(std::ios::failbit);
+  }
+  if (std::streambuf::traits_type::eq_int_type(buffer.sgetc(), std::streambuf::traits_type::eof())) {
+    input.setstate(std::ios::eofbit);
+  }
+  biggie.is_positive = !is_negative;
+  biggie.adduction();
   return input;
 }
+
+// an odd modulus works in Montgomery form and reduces with REDC, an even one falls back to the division
+class BigInteger::Modulus {
+ public:
+  explicit Modulus(const BigInteger& mod) : modulus(mod.abs()), length(modulus.blocks_amount) {
+    if (is_odd()) {
+      // every Newton step doubles the number of correct low bits of the inverse
+      limb inverse = 1;
+      for (int i = 0; i < 5; ++i) {
+        inverse *= 2 - modulus.blocks[0] * inverse;
+      }
+      factor = 0 - inverse;
+    }
+  }
+
+  const BigInteger& value() const {
+    return modulus;
+  }
+  BigInteger reduce(const BigInteger& num) const {
+    BigInteger result = num % modulus;
+    if (!result.is_positive) result += modulus;
+    return result;
+  }
+  BigInteger multiply(const BigInteger& num_1, const BigInteger& num_2) const {
+    return reduce(num_1 * num_2);
+  }
+  // sliding window exponentiation, a negative exponent throws std::domain_error
+  BigInteger pow(const BigInteger& num, const BigInteger& exponent) const {
+    if (exponent < 0) throw std::domain_error("BigInteger::Modulus::pow: negative exponent");
+    if (length == 1 && modulus.blocks[0] == 1) return 0;
+    size_t bits = exponent.bit_length();
+    int window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 6 ? 2 : 1;
+    // odd powers num^1, num^3, ..., num^(2^window - 1)
+    Limbs table(length << (window - 1));
+    Limbs scratch(2 * length + 1);
+    Limbs square(length);
+    to_form(table.data(), num);
+    multiply_blocks(square.data(), table.data(), table.data(), scratch.data());
+    for (size_t i = 1; i < size_t(1) << (window - 1); ++i) {
+      multiply_blocks(table.data() + i * length, table.data() + (i - 1) * length, square.data(), scratch.data());
+    }
+    Limbs result(length);
+    to_form(result.data(), 1);
+    auto bit = [&exponent](size_t index) {
+      return (exponent.blocks[index / limb_bits] >> (index % limb_bits)) & 1;
+    };
+    for (size_t i = bits; i > 0;) {
+      if (!bit(i - 1)) {
+        multiply_blocks(result.data(), result.data(), result.data(), scratch.data());
+        --i;
+        continue;
+      }
+      // the longest window ending in a set bit
+      size_t low = i > size_t(window) ? i - window : 0;
+      while (!bit(low)) ++low;
+      size_t digit = 0;
+      for (size_t j = i; j > low; --j) {
+        multiply_blocks(result.data(), result.data(), result.data(), scratch.data());
+        digit = digit << 1 | bit(j - 1);
+      }
+      multiply_blocks(result.data(), result.data(), table.data() + (digit >> 1) * length, scratch.data());
+      i = low;
+    }
+    if (is_odd()) {
+      std::fill(scratch.begin(), scratch.end(), 0);
+      std::copy(result.begin(), result.end(), scratch.begin());
+      redc(result.data(), scratch.data());
+    }
+    return from_blocks(result.data(), length);
+  }
+
+ private:
+  BigInteger modulus;
+  size_t length;
+  // -modulus^(-1) mod base, for an odd modulus
+  limb factor = 0;
+
+  bool is_odd() const {
+    return modulus.blocks[0] & 1;
+  }
+  // length blocks of num * base^length mod modulus for an odd modulus, of num mod modulus otherwise
+  void to_form(limb* result, const BigInteger& num) const {
+    BigInteger value = reduce(num);
+    if (is_odd()) {
+      value.shift_blocks(length);
+      value %= modulus;
+    }
+    std::fill(result, result + length, 0);
+    std::copy(value.blocks.begin(), value.blocks.begin() + value.blocks_amount, result);
+  }
+  // result = product / base^length mod modulus, product has 2 * length + 1 blocks and is less than
+  // modulus * base^length; product is overwritten
+  void redc(limb* result, limb* product) const {
+    const limb* mod = modulus.blocks.data();
+    for (size_t i = 0; i < length; ++i) {
+      // the multiple of the modulus that clears block i
+      limb multiple = product[i] * factor;
+      wide carry = 0;
+      for (size_t j = 0; j < length; ++j) {
+        wide current = wide(multiple) * mod[j] + product[i + j] + carry;
+        product[i + j] = limb(current);
+        carry = current >> limb_bits;
+      }
+      for (size_t j = i + length; carry != 0; ++j) {
+        wide current = product[j] + carry;
+        product[j] = limb(current);
+        carry = current >> limb_bits;
+      }
+    }
+    limb* high = product + length;
+    if (high[length] != 0 || compare_blocks(high, length, mod, length) >= 0) {
+      subtract_blocks(high, length + 1, mod, length);
+    }
+    std::copy(high, high + length, result);
+  }
+  // result = first * second in the form of to_form, result may alias the operands
+  void multiply_blocks(limb* result, const limb* first, const limb* second, limb* scratch) const {
+    multiply_unsigned(scratch, first, length, second, length);
+    if (is_odd()) {
+      scratch[2 * length] = 0;
+      redc(result, scratch);
+      return;
+    }
+    BigInteger product = from_blocks(scratch, 2 * length);
+    product %= modulus;
+    std::fill(result, result + length, 0);
+    std::copy(product.blocks.begin(), product.blocks.begin() + product.blocks_amount, result);
+  }
+};
+
+BigInteger BigInteger::pow_mod(const BigInteger& exponent, const BigInteger& mod) const {
+  return Modulus(mod).pow(*this, exponent);
+}
+
+// a read-only number over a record of the binary format, for instance in a memory-mapped file: the blocks are
+// used in place, nothing is copied until value() is called
+class BigIntegerView {
+ public:
+  // the record has to start at a 4-byte aligned address, as every record of a file of them does
+  explicit BigIntegerView(std::span<const std::byte> record) : length(BigInteger::serial_length(record)) {
+    if constexpr (std::endian::native != std::endian::little) {
+      throw std::logic_error("BigIntegerView: the blocks of a record are little-endian");
+    }
+    if (reinterpret_cast<std::uintptr_t>(record.data()) % alignof(uint32_t) != 0) {
+      throw std::invalid_argument("BigIntegerView: unaligned record");
+    }
+    is_positive = record[1] == std::byte{0};
+    data = reinterpret_cast<const uint32_t*>(record.data() + BigInteger::serial_header_size);
+  }
+
+  bool is_negative() const {
+    return !is_positive;
+  }
+  std::span<const uint32_t> blocks() const {
+    return {data, length};
+  }
+  // the size of the record in bytes, the next record starts right after it
+  size_t size() const {
+    return BigInteger::serial_header_size + sizeof(uint32_t) * length;
+  }
+  BigInteger value() const {
+    BigInteger result = BigInteger::from_blocks(data, length);
+    result.is_positive = is_positive;
+    result.adduction();
+    return result;
+  }
+
+ private:
+  const uint32_t* data;
+  size_t length;
+  bool is_positive;
+};
+// expression templates: fused(a) * b + fused(c) * d - e builds a FusedSum of references instead of temporaries, and
+// BigInteger evaluates it in one pass when it is assigned or converted. The nodes refer to their operands, so an
+// expression has to be evaluated within the statement that builds it and must not be kept in an auto variable.
+class FusedFactor {
+ public:
+  explicit FusedFactor(const BigInteger& num) : num(&num) {}
+  const BigInteger& value() const {
+    return *num;
+  }
+
+ private:
+  const BigInteger* num;
+};
+
+class FusedProduct {
+ public:
+  FusedProduct(const BigInteger& first, const BigInteger& second) : first(&first), second(&second) {}
+  FusedTerm term() const {
+    return {first, second, false};
+  }
+
+ private:
+  const BigInteger* first;
+  const BigInteger* second;
+};
+
+// a sum of Count signed terms, each a number or a product of two numbers
+template<size_t Count>
+struct FusedSum {
+  std::array<FusedTerm, Count> terms;
+};
+
+inline FusedFactor fused(const BigInteger& num) {
+  return FusedFactor(num);
+}
+
+inline FusedSum<1> as_fused_sum(const BigInteger& num) {
+  return {{FusedTerm{&num, nullptr, false}}};
+}
+inline FusedSum<1> as_fused_sum(const FusedFactor& factor) {
+  return as_fused_sum(factor.value());
+}
+inline FusedSum<1> as_fused_sum(const FusedProduct& product) {
+  return {{product.term()}};
+}
+template<size_t Count>
+const FusedSum<Count>& as_fused_sum(const FusedSum<Count>& sum) {
+  return sum;
+}
+
+// the terms of first followed by those of second, negated if subtract is set
+template<size_t First, size_t Second>
+FusedSum<First + Second> join_fused(const FusedSum<First>& first, const FusedSum<Second>& second, bool subtract) {
+  FusedSum<First + Second> result;
+  std::copy(first.terms.begin(), first.terms.end(), result.terms.begin());
+  for (size_t i = 0; i < Second; ++i) {
+    result.terms[First + i] = second.terms[i];
+    result.terms[First + i].negative = second.terms[i].negative != subtract;
+  }
+  return result;
+}
+
+// only products of two factors are fused, a longer product falls back to the conversion into BigInteger
+inline FusedProduct operator*(const FusedFactor& first, const BigInteger& second) {
+  return {first.value(), second};
+}
+inline FusedProduct operator*(const BigInteger& first, const FusedFactor& second) {
+  return {first, second.value()};
+}
+inline FusedProduct operator*(const FusedFactor& first, const FusedFactor& second) {
+  return {first.value(), second.value()};
+}
+template<FusedOperand First, FusedOperand Second>
+  requires (FusedExpression<First> || FusedExpression<Second>)
+auto operator+(const First& first, const Second& second) {
+  return join_fused(as_fused_sum(first), as_fused_sum(second), false);
+}
+template<FusedOperand First, FusedOperand Second>
+  requires (FusedExpression<First> || FusedExpression<Second>)
+auto operator-(const First& first, const Second& second) {
+  return join_fused(as_fused_sum(first), as_fused_sum(second), true);
+}
+template<FusedExpression Expression>
+auto operator-(const Expression& expression) {
+  return join_fused(FusedSum<0>(), as_fused_sum(expression), true);
+}
+
+template<FusedExpression Expression>
+BigInteger::BigInteger(const Expression& expression) {
+  const auto& sum = as_fused_sum(expression);
+  assign_terms(sum.terms.data(), sum.terms.size());
+}
+template<FusedExpression Expression>
+BigInteger& BigInteger::operator=(const Expression& expression) {
+  const auto& sum = as_fused_sum(expression);
+  assign_terms(sum.terms.data(), sum.terms.size());
+  return *this;
+}
+template<FusedExpression Expression>
+BigInteger& BigInteger::operator+=(const Expression& expression) {
+  auto sum = join_fused(as_fused_sum(*this), as_fused_sum(expression), false);
+  assign_terms(sum.terms.data(), sum.terms.size());
+  return *this;
+}
+template<FusedExpression Expression>
+BigInteger& BigInteger::operator-=(const Expression& expression) {
+  auto sum = join_fused(as_fused_sum(*this), as_fused_sum(expression), true);
+  assign_terms(sum.terms.data(), sum.terms.size());
+  return *this;
+}
+
 //######################################################################################################################
 class Rational {
  public:
   Rational() = default;
   Rational(const BigInteger& num) : numerator(num) {}
+  Rational(BigInteger&& num) : numerator(std::move(num)) {}
   Rational(int num) : numerator(num) {}
   Rational& operator+=(const Rational& num) {
-    numerator *= num.denominator;
-    numerator += num.numerator * denominator;
+    numerator = fused(numerator) * num.denominator + fused(num.numerator) * denominator;
     denominator *= num.denominator;
-    shrink();
+    is_reduced = false;
+    settle();
     return *this;
   }
   Rational& operator-=(const Rational& num) {
-    numerator *= num.denominator;
-    numerator -= num.numerator * denominator;
+    numerator = fused(numerator) * num.denominator - fused(num.numerator) * denominator;
     denominator *= num.denominator;
-    shrink();
+    is_reduced = false;
+    settle();
     return *this;
   }
+  // a/b * c/d: the common factors of a and d and of c and b cancel before multiplying,
+  // so the product of reduced fractions comes out reduced
   Rational& operator*=(const Rational& num) {
-    numerator *= num.numerator;
-    denominator *= num.denominator;
-    shrink();
+    BigInteger first_gcd = gcd(numerator, num.denominator);
+    BigInteger second_gcd = gcd(num.numerator, denominator);
+    BigInteger other_numerator = num.numerator / second_gcd;
+    BigInteger other_denominator = num.denominator / first_gcd;
+    numerator /= first_gcd;
+    denominator /= second_gcd;
+    numerator *= other_numerator;
+    denominator *= other_denominator;
+    is_reduced = is_reduced && num.is_reduced;
+    settle();
     return *this;
   }
+  // a/b / c/d: the same with a and c and with d and b
   Rational& operator/=(const Rational& num) {
-    numerator *= num.denominator;
-    if (num.numerator < 0) {
-      numerator *= -1;
-      denominator *= (-num.numerator);
-    } else {
-      denominator *= num.numerator;
+    BigInteger first_gcd = gcd(numerator, num.numerator);
+    BigInteger second_gcd = gcd(num.denominator, denominator);
+    BigInteger other_numerator = num.denominator / second_gcd;
+    BigInteger other_denominator = num.numerator / first_gcd;
+    numerator /= first_gcd;
+    denominator /= second_gcd;
+    numerator *= other_numerator;
+    denominator *= other_denominator;
+    if (denominator < 0) {
+      numerator = -std::move(numerator);
+      denominator = -std::move(denominator);
     }
-    shrink();
+    is_reduced = is_reduced && num.is_reduced;
+    settle();
     return *this;
   }
-  friend bool operator<(const Rational& num_1, const Rational& num_2);
+
+  // while the returned scope lives, arithmetic on this thread skips reduction
+  // until a fraction grows past lazy_threshold bits or is read
+  class LazyScope {
+   public:
+    LazyScope() {
+      ++lazy_depth;
+    }
+    LazyScope(const LazyScope&) = delete;
+    LazyScope& operator=(const LazyScope&) = delete;
+    ~LazyScope() {
+      --lazy_depth;
+    }
+  };
+  static LazyScope lazy() {
+    return LazyScope();
+  }
+  static inline size_t lazy_threshold = 1024;
+
+  // reduces the fraction; reading it in any way does this first
+  void normalize() const {
+    if (!is_reduced) {
+      shrink();
+    }
+  }
+  // -1, 0 or 1 as the fraction is less than, equal to or greater than num; the signs and then the lengths of the
+  // fractions decide most comparisons, only close magnitudes are cross-multiplied
+  int compare(const Rational& num) const {
+    int sign = numerator.sign();
+    if (sign != num.numerator.sign()) return sign < num.numerator.sign() ? -1 : 1;
+    if (sign == 0) return 0;
+    if (denominator == num.denominator) return numerator.compare(num.numerator);
+    // a/b lies in (2^(len(a) - len(b) - 1), 2^(len(a) - len(b) + 1))
+    long long length = (long long) numerator.bit_length() - (long long) denominator.bit_length();
+    long long other_length = (long long) num.numerator.bit_length() - (long long) num.denominator.bit_length();
+    if (length >= other_length + 2) return sign;
+    if (other_length >= length + 2) return -sign;
+    return (numerator * num.denominator).compare(num.numerator * denominator);
+  }
+  friend bool operator==(const Rational& num_1, const Rational& num_2);
   explicit operator double() {
-    std::string output = asDecimal(20);
-    return std::atof(output.c_str());
+    return to_double();
+  }
+  // correctly rounded: the quotient keeps two bits below the last bit of the double, the remainder is sticky
+  double to_double() const {
+    normalize();
+    if (numerator == 0) return 0;
+    BigInteger magnitude = numerator.abs();
+    BigInteger divisor = denominator;
+    long long shift = 55 + (long long) divisor.bit_length() - (long long) magnitude.bit_length();
+    // subnormal results keep fewer bits, the smallest one is 2^-1074
+    shift = std::min<long long>(shift, 1076);
+    if (shift >= 0) {
+      magnitude <<= shift;
+    } else {
+      divisor <<= -shift;
+    }
+    BigInteger quotient = magnitude / divisor;
+    bool is_inexact = quotient * divisor != magnitude;
+    uint64_t bits = uint64_t(static_cast<long long>(quotient)) | is_inexact;
+    double result = std::ldexp(double(bits), int(-shift));
+    return numerator < 0 ? -result : result;
   }
 
   std::string toString() const {
+    normalize();
     std::string output = numerator.toString();
     if (denominator != 1) {
       output.push_back('/');
@@ -438,45 +2742,80 @@ class Rational {
     }
     return output;
   }
-  std::string asDecimal(blocks_amount_t precision = 0) {
+  // the reduced fraction as two records of the BigInteger binary format, the numerator and the denominator
+  size_t serialized_size() const {
+    normalize();
+    return numerator.serialized_size() + denominator.serialized_size();
+  }
+  size_t serialize(std::span<std::byte> output) const {
+    if (output.size() < serialized_size()) throw std::length_error("Rational::serialize");
+    size_t size = numerator.serialize(output);
+    return size + denominator.serialize(output.subspan(size));
+  }
+  static Rational deserialize(std::span<const std::byte> input) {
+    Rational result;
+    result.numerator = BigInteger::deserialize(input);
+    result.denominator = BigInteger::deserialize(input.subspan(result.numerator.serialized_size()));
+    if (result.denominator <= 0) throw std::invalid_argument("Rational::deserialize: bad denominator");
+    // a record written elsewhere need not hold a reduced fraction
+    result.shrink();
+    return result;
+  }
+  // precision digits after the point, the rest is cut off; all of them come out of one division
+  std::string asDecimal(size_t precision = 0) const {
+    normalize();
+    BigInteger scaled = numerator.abs();
+    scaled *= power_of_ten(precision);
+    scaled /= denominator;
+    std::string digits = scaled.toString();
+    if (digits.size() <= precision) {
+      digits.insert(0, precision + 1 - digits.size(), '0');
+    }
     std::string precised;
-    BigInteger copy = numerator;
-    if (numerator * denominator < 0 && copy / denominator == 0) precised += '-';
-    precised += (copy / denominator).toString();
-    copy = copy.abs();
-    copy %= denominator;
-    for (blocks_amount_t i = 0; i <= precision; ++i) {
-      if (i == 0) precised.push_back('.');
-      else {
-        copy *= 10;
-        precised += (copy / denominator).toString();
-        copy %= denominator;
-      }
+    if (numerator < 0) {
+      precised.push_back('-');
     }
+    precised.append(digits, 0, digits.size() - precision);
+    precised.push_back('.');
+    precised.append(digits, digits.size() - precision, precision);
     return precised;
   }
  private:
-  BigInteger numerator;
-  BigInteger denominator = 1;
+  // a lazy fraction is reduced in place when it is read, even through a const reference
+  mutable BigInteger numerator;
+  mutable BigInteger denominator = 1;
+  mutable bool is_reduced = true;
+  static inline thread_local int lazy_depth = 0;
 
-  BigInteger gcd(const BigInteger& num_1, const BigInteger& num_2) {
-    if (num_2 == 0) return num_1;
-    return gcd(num_2, num_1 % num_2);
+  static BigInteger power_of_ten(size_t exponent) {
+    BigInteger result = 1;
+    BigInteger square = 10;
+    for (; exponent > 0; exponent /= 2) {
+      if (exponent % 2 == 1) result *= square;
+      if (exponent > 1) square *= square;
+    }
+    return result;
   }
-  void shrink() {
-    BigInteger num = numerator.abs();
-    BigInteger den = denominator.abs();
+  void shrink() const {
+    if constexpr (BigIntegerStats::enabled) {
+      size_t numerator_limbs = (numerator.bit_length() + 31) / 32;
+      size_t denominator_limbs = (denominator.bit_length() + 31) / 32;
+      BigIntegerStats::record(BigIntegerStats::Operation::shrink, std::max(numerator_limbs, denominator_limbs),
+                              numerator_limbs + denominator_limbs);
+    }
     if (denominator != 1) {
-      while (den != 0) {
-        std::swap(num, den);
-        den %= num;
-      }
-      BigInteger gcf = num;
+      BigInteger gcf = gcd(numerator, denominator);
       if (gcf != 1) {
         numerator /= gcf;
         denominator /= gcf;
       }
     }
+    is_reduced = true;
+  }
+  void settle() {
+    if (is_reduced) return;
+    if (lazy_depth > 0 && numerator.bit_length() + denominator.bit_length() < lazy_threshold) return;
+    shrink();
   }
 };
 
@@ -485,21 +2824,37 @@ Rational operator+(const Rational& num_1, const Rational& num_2) {
   copy += num_2;
   return copy;
 }
+Rational operator+(Rational&& num_1, const Rational& num_2) {
+  num_1 += num_2;
+  return std::move(num_1);
+}
 Rational operator-(const Rational& num_1, const Rational& num_2) {
   Rational copy = num_1;
   copy -= num_2;
   return copy;
 }
+Rational operator-(Rational&& num_1, const Rational& num_2) {
+  num_1 -= num_2;
+  return std::move(num_1);
+}
 Rational operator*(const Rational& num_1, const Rational& num_2) {
   Rational copy = num_1;
   copy *= num_2;
   return copy;
 }
+Rational operator*(Rational&& num_1, const Rational& num_2) {
+  num_1 *= num_2;
+  return std::move(num_1);
+}
 Rational operator/(const Rational& num_1, const Rational& num_2) {
   Rational copy = num_1;
   copy /= num_2;
   return copy;
 }
+Rational operator/(Rational&& num_1, const Rational& num_2) {
+  num_1 /= num_2;
+  return std::move(num_1);
+}
 Rational operator-(const Rational& num_1) {
   Rational copy = num_1;
   copy *= -1;
@@ -507,23 +2862,29 @@ Rational operator-(const Rational& num_1) {
 
 }
 
+std::strong_ordering operator<=>(const Rational& num_1, const Rational& num_2) {
+  return num_1.compare(num_2) <=> 0;
+}
 bool operator<(const Rational& num_1, const Rational& num_2) {
-  return num_1.numerator * num_2.denominator < num_2.numerator * num_1.denominator;
+  return num_1.compare(num_2) < 0;
 }
 bool operator>(const Rational& num_1, const Rational& num_2) {
-  return num_2 < num_1;
+  return num_1.compare(num_2) > 0;
 }
+// reduced fractions with positive denominators are equal exactly when their parts are
 bool operator==(const Rational& num_1, const Rational& num_2) {
-  return !(num_2 < num_1 || num_1 < num_2);
+  num_1.normalize();
+  num_2.normalize();
+  return num_1.numerator == num_2.numerator && num_1.denominator == num_2.denominator;
 }
 bool operator!=(const Rational& num_1, const Rational& num_2) {
   return !(num_1 == num_2);
 }
 bool operator<=(const Rational& num_1, const Rational& num_2) {
-  return !(num_1 > num_2);
+  return num_1.compare(num_2) <= 0;
 }
 bool operator>=(const Rational& num_1, const Rational& num_2) {
-  return !(num_1 < num_2);
+  return num_1.compare(num_2) >= 0;
 }
 std::istream& operator>>(std::istream& input, Rational& rattie) {
   input.tie(nullptr);
@@ -536,4 +2897,349 @@ std::ostream& operator<<(std::ostream& output, const Rational& biggie) {
   output.tie(nullptr);
   output << biggie.toString();
   return output;
-}
\ No newline at end of file
+}//######################################################################################################################
+// Bits-wide two's complement integer on the stack; like the built-in integers, arithmetic wraps around on overflow
+template<size_t Bits>
+class FixedBigInteger {
+  static_assert(Bits % 32 == 0 && Bits >= 64, "FixedBigInteger is made of at least two 32-bit limbs");
+
+ public:
+  constexpr FixedBigInteger() = default;
+  constexpr FixedBigInteger(long long num) {
+    uint64_t value = uint64_t(num);
+    limbs[0] = limb(value);
+    limbs[1] = limb(value >> limb_bits);
+    for (size_t i = 2; i < size; ++i) {
+      limbs[i] = num < 0 ? ~limb(0) : 0;
+    }
+  }
+  // same grammar as BigInteger; in a constant expression a bad string fails to compile
+  constexpr FixedBigInteger(const std::string& num) {
+    bool is_negative = !num.empty() && num[0] == '-';
+    bool has_sign = !num.empty() && (num[0] == '-' || num[0] == '+');
+    if (num.size() == size_t(has_sign) ||
+        !std::all_of(num.begin() + has_sign, num.end(), [](char digit) { return digit >= '0' && digit <= '9'; })) {
+      throw std::invalid_argument("FixedBigInteger: not a decimal number");
+    }
+    for (size_t i = has_sign; i < num.size(); ++i) {
+      multiply_add_small(10, limb(num[i] - '0'));
+    }
+    if (is_negative) negate();
+  }
+  // keeps the low Bits bits of the value
+  explicit FixedBigInteger(const BigInteger& num) {
+    for (size_t i = 0; i < size && i < size_t(num.blocks_amount); ++i) {
+      limbs[i] = num.blocks[i];
+    }
+    if (!num.is_positive) negate();
+  }
+  explicit operator BigInteger() const {
+    FixedBigInteger magnitude = abs();
+    BigInteger result = BigInteger::from_blocks(magnitude.limbs.data(), size);
+    result.is_positive = !is_negative();
+    result.adduction();
+    return result;
+  }
+
+  constexpr FixedBigInteger& operator+=(const FixedBigInteger& num) {
+    wide carry = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < size; ++i) {
+      wide current = wide(limbs[i]) + num.limbs[i] + carry;
+      limbs[i] = limb(current);
+      carry = current >> limb_bits;
+    }
+    return *this;
+  }
+  constexpr FixedBigInteger& operator-=(const FixedBigInteger& num) {
+    wide borrow = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < size; ++i) {
+      wide current = wide(limbs[i]) - num.limbs[i] - borrow;
+      limbs[i] = limb(current);
+      borrow = (current >> limb_bits) & 1;
+    }
+    return *this;
+  }
+  // magnitudes are multiplied, so that numbers well below the width skip their zero limbs
+  constexpr FixedBigInteger& operator*=(const FixedBigInteger& num) {
+    bool is_negative_product = is_negative() != num.is_negative();
+    FixedBigInteger first = abs();
+    FixedBigInteger second = num.abs();
+    size_t first_length = first.length();
+    size_t second_length = second.length();
+    limbs = {};
+    for (size_t i = 0; i < first_length; ++i) {
+      wide carry = 0;
+      for (size_t j = 0; j < second_length && i + j < size; ++j) {
+        wide current = wide(first.limbs[i]) * second.limbs[j] + limbs[i + j] + carry;
+        limbs[i + j] = limb(current);
+        carry = current >> limb_bits;
+      }
+      if (i + second_length < size) limbs[i + second_length] = limb(carry);
+    }
+    if (is_negative_product) negate();
+    return *this;
+  }
+  // rounds towards zero, the remainder takes the sign of the dividend
+  constexpr FixedBigInteger& operator/=(const FixedBigInteger& num) {
+    bool is_negative_quotient = is_negative() != num.is_negative();
+    FixedBigInteger remainder;
+    divide_magnitudes(abs(), num.abs(), *this, remainder);
+    if (is_negative_quotient) negate();
+    return *this;
+  }
+  constexpr FixedBigInteger& operator%=(const FixedBigInteger& num) {
+    bool is_negative_remainder = is_negative();
+    FixedBigInteger quotient;
+    divide_magnitudes(abs(), num.abs(), quotient, *this);
+    if (is_negative_remainder) negate();
+    return *this;
+  }
+  constexpr FixedBigInteger& operator<<=(size_t shift) {
+    size_t count = shift / limb_bits;
+    int bits = int(shift % limb_bits);
+    for (size_t i = size; i-- > 0;) {
+      limb high = i >= count ? limbs[i - count] : 0;
+      limb low = i >= count + 1 ? limbs[i - count - 1] : 0;
+      limbs[i] = bits == 0 ? high : (high << bits) | (low >> (limb_bits - bits));
+    }
+    return *this;
+  }
+  // rounds down, like the shift of a built-in integer
+  constexpr FixedBigInteger& operator>>=(size_t shift) {
+    size_t count = shift / limb_bits;
+    int bits = int(shift % limb_bits);
+    limb fill = is_negative() ? ~limb(0) : 0;
+    for (size_t i = 0; i < size; ++i) {
+      limb low = i + count < size ? limbs[i + count] : fill;
+      limb high = i + count + 1 < size ? limbs[i + count + 1] : fill;
+      limbs[i] = bits == 0 ? low : (low >> bits) | (high << (limb_bits - bits));
+    }
+    return *this;
+  }
+  constexpr FixedBigInteger& operator++() {
+    return *this += 1;
+  }
+  constexpr FixedBigInteger& operator--() {
+    return *this -= 1;
+  }
+  constexpr FixedBigInteger operator++(int) {
+    FixedBigInteger copy = *this;
+    ++(*this);
+    return copy;
+  }
+  constexpr FixedBigInteger operator--(int) {
+    FixedBigInteger copy = *this;
+    --(*this);
+    return copy;
+  }
+
+  constexpr explicit operator long long() const {
+    return (long long) (uint64_t(limbs[0]) | uint64_t(limbs[1]) << limb_bits);
+  }
+  constexpr explicit operator int() const {
+    return int(static_cast<long long>(*this));
+  }
+  constexpr explicit operator bool() const {
+    for (limb current : limbs) {
+      if (current != 0) return true;
+    }
+    return false;
+  }
+  constexpr bool is_negative() const {
+    return limbs[size - 1] >> (limb_bits - 1);
+  }
+  constexpr FixedBigInteger abs() const {
+    FixedBigInteger copy = *this;
+    if (is_negative()) copy.negate();
+    return copy;
+  }
+  constexpr std::string toString() const {
+    // pr digits at a time from the lowest ones, like the schoolbook BigInteger conversion
+    FixedBigInteger magnitude = abs();
+    std::string output;
+    do {
+      limb chunk = magnitude.divide_small(decimal_base);
+      bool is_last = !magnitude;
+      for (int i = 0; i < pr && (!is_last || chunk != 0 || i == 0); ++i) {
+        output.push_back(char('0' + chunk % 10));
+        chunk /= 10;
+      }
+    } while (magnitude);
+    if (is_negative()) output.push_back('-');
+    std::reverse(output.begin(), output.end());
+    return output;
+  }
+
+  friend constexpr FixedBigInteger operator+(FixedBigInteger num_1, const FixedBigInteger& num_2) {
+    return num_1 += num_2;
+  }
+  friend constexpr FixedBigInteger operator-(FixedBigInteger num_1, const FixedBigInteger& num_2) {
+    return num_1 -= num_2;
+  }
+  friend constexpr FixedBigInteger operator*(FixedBigInteger num_1, const FixedBigInteger& num_2) {
+    return num_1 *= num_2;
+  }
+  friend constexpr FixedBigInteger operator/(FixedBigInteger num_1, const FixedBigInteger& num_2) {
+    return num_1 /= num_2;
+  }
+  friend constexpr FixedBigInteger operator%(FixedBigInteger num_1, const FixedBigInteger& num_2) {
+    return num_1 %= num_2;
+  }
+  friend constexpr FixedBigInteger operator<<(FixedBigInteger num, size_t shift) {
+    return num <<= shift;
+  }
+  friend constexpr FixedBigInteger operator>>(FixedBigInteger num, size_t shift) {
+    return num >>= shift;
+  }
+  friend constexpr FixedBigInteger operator-(FixedBigInteger num) {
+    num.negate();
+    return num;
+  }
+
+  friend constexpr bool operator==(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    return num_1.limbs == num_2.limbs;
+  }
+  friend constexpr bool operator!=(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    return !(num_1 == num_2);
+  }
+  friend constexpr bool operator<(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    if (num_1.is_negative() != num_2.is_negative()) return num_1.is_negative();
+    for (size_t i = size; i-- > 0;) {
+      if (num_1.limbs[i] != num_2.limbs[i]) return num_1.limbs[i] < num_2.limbs[i];
+    }
+    return false;
+  }
+  friend constexpr bool operator>(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    return num_2 < num_1;
+  }
+  friend constexpr bool operator<=(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    return !(num_2 < num_1);
+  }
+  friend constexpr bool operator>=(const FixedBigInteger& num_1, const FixedBigInteger& num_2) {
+    return !(num_1 < num_2);
+  }
+
+ private:
+  using limb = uint32_t;
+  using wide = uint64_t;
+  static constexpr int limb_bits = 32;
+  static constexpr size_t size = Bits / limb_bits;
+  static constexpr int pr = 9;
+  static constexpr limb decimal_base = 1'000'000'000;
+
+  std::array<limb, size> limbs{}; // two's complement, in reverse order
+
+  // limbs without the leading zero ones, at least one
+  constexpr size_t length() const {
+    size_t result = size;
+    while (result > 1 && limbs[result - 1] == 0) --result;
+    return result;
+  }
+  constexpr void negate() {
+    for (limb& current : limbs) current = ~current;
+    ++(*this);
+  }
+  // *this = *this * factor + addend, the magnitude is taken unsigned
+  constexpr void multiply_add_small(limb factor, limb addend) {
+    wide carry = addend;
+    for (limb& current : limbs) {
+      wide product = wide(current) * factor + carry;
+      current = limb(product);
+      carry = product >> limb_bits;
+    }
+  }
+  // unsigned short division, returns the remainder
+  constexpr limb divide_small(limb divisor) {
+    wide remainder = 0;
+    for (size_t i = size; i-- > 0;) {
+      wide current = (remainder << limb_bits) | limbs[i];
+      limbs[i] = limb(current / divisor);
+      remainder = current % divisor;
+    }
+    return limb(remainder);
+  }
+  // Knuth's algorithm D on the unsigned values of both numbers
+  static constexpr void divide_magnitudes(const FixedBigInteger& dividend, const FixedBigInteger& divisor,
+                                          FixedBigInteger& quotient, FixedBigInteger& remainder) {
+    size_t divisor_length = divisor.length();
+    size_t dividend_length = dividend.length();
+    quotient = 0;
+    if (divisor_length == 1) {
+      quotient = dividend;
+      remainder = quotient.divide_small(divisor.limbs[0]);
+      return;
+    }
+    if (dividend_length < divisor_length) {
+      remainder = dividend;
+      return;
+    }
+    int shift = std::countl_zero(divisor.limbs[divisor_length - 1]);
+    std::array<limb, size> normalized{};
+    std::array<limb, size + 1> window{};
+    for (size_t i = size; i-- > 0;) {
+      window[i + 1] |= shift == 0 ? 0 : dividend.limbs[i] >> (limb_bits - shift);
+      window[i] = dividend.limbs[i] << shift;
+      normalized[i] = (divisor.limbs[i] << shift) |
+                      (shift == 0 || i == 0 ? 0 : divisor.limbs[i - 1] >> (limb_bits - shift));
+    }
+    wide divisor_top = normalized[divisor_length - 1];
+    wide divisor_next = normalized[divisor_length - 2];
+    for (size_t j = dividend_length - divisor_length + 1; j-- > 0;) {
+      wide current = (wide(window[j + divisor_length]) << limb_bits) | window[j + divisor_length - 1];
+      wide digit = current / divisor_top;
+      wide rest = current % divisor_top;
+      while (digit >> limb_bits ||
+             digit * divisor_next > ((rest << limb_bits) | window[j + divisor_length - 2])) {
+        --digit;
+        rest += divisor_top;
+        if (rest >> limb_bits) break;
+      }
+      wide carry = 0;
+      wide borrow = 0;
+      for (size_t i = 0; i < divisor_length; ++i) {
+        wide product = digit * normalized[i] + carry;
+        carry = product >> limb_bits;
+        wide current_block = wide(window[i + j]) - limb(product) - borrow;
+        window[i + j] = limb(current_block);
+        borrow = (current_block >> limb_bits) & 1;
+      }
+      wide top = wide(window[j + divisor_length]) - carry - borrow;
+      window[j + divisor_length] = limb(top);
+      if (top >> limb_bits) {
+        // the estimate was one too big: add the divisor back
+        --digit;
+        wide sum_carry = 0;
+        for (size_t i = 0; i < divisor_length; ++i) {
+          wide sum = wide(window[i + j]) + normalized[i] + sum_carry;
+          window[i + j] = limb(sum);
+          sum_carry = sum >> limb_bits;
+        }
+        window[j + divisor_length] += limb(sum_carry);
+      }
+      quotient.limbs[j] = limb(digit);
+    }
+    remainder = 0;
+    for (size_t i = 0; i < divisor_length; ++i) {
+      remainder.limbs[i] = (window[i] >> shift) | (shift == 0 ? 0 : window[i + 1] << (limb_bits - shift));
+    }
+  }
+};
+
+template<size_t Bits>
+std::ostream& operator<<(std::ostream& output, const FixedBigInteger<Bits>& num) {
+  output << num.toString();
+  return output;
+}
+template<size_t Bits>
+std::istream& operator>>(std::istream& input, FixedBigInteger<Bits>& num) {
+  std::string input_num;
+  if (!(input >> input_num)) return input;
+  try {
+    num = FixedBigInteger<Bits>(input_num);
+  } catch (const std::invalid_argument&) {
+    input.setstate(std::ios::failbit);
+  }
+  return input;
+}
@@ -0,0 +1,1828 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <random>
+#include <tuple>
+#include <iostream>
+#include <sstream>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <span>
+#include <cstring>
+#include <stdexcept>
+#include <atomic>
+
+#include "biginteger.cpp"
+
+std::atomic<size_t> allocations = 0;
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size)) return pointer;
+  throw std::bad_alloc();
+}
+// out of line, so that GCC does not match the inlined free against the built-in new
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+[[gnu::noinline]] void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+std::string RandomDigits(std::mt19937_64& gen, size_t length) {
+  std::string digits(length, '0');
+  for (auto& digit : digits) digit = char('0' + gen() % 10);
+  if (length > 0) digits[0] = char('1' + gen() % 9);
+  return digits;
+}
+
+// a number with this many decimal digits takes about the given amount of blocks
+size_t DigitsForBlocks(size_t blocks) {
+  return blocks * 9633 / 1000;
+}
+
+BigInteger RandomBigInteger(std::mt19937_64& gen, size_t length) {
+  std::string digits = RandomDigits(gen, length);
+  if (gen() % 2) digits.insert(digits.begin(), '-');
+  return BigInteger(digits);
+}
+
+template<typename Func>
+double Measure(Func func, int repeats = 1) {
+  using namespace std::chrono;
+  auto start = steady_clock::now();
+  for (int i = 0; i < repeats; ++i) func();
+  return duration<double, std::milli>(steady_clock::now() - start).count() / repeats;
+}
+
+void BasicTest() {
+  BigInteger first("123456789012345678901234567890");
+  BigInteger second("-987654321987654321");
+
+  assert((first + second).toString() == "123456789011358024579246913569");
+  assert((first - second).toString() == "123456789013333333223222222211");
+  assert((first * second).toString() == "-121932631246761163237311385323609205901126352690");
+  assert((first / second).toString() == "-124999998748");
+  assert((first % second).toString() == "432099904777777782");
+  assert((second - second).toString() == "0");
+  assert(BigInteger("-0").toString() == "0");
+  assert(BigInteger(5000000000).toString() == "5000000000");
+  assert(BigInteger(-9223372036854775807LL - 1).toString() == "-9223372036854775808");
+  assert(static_cast<long long>(BigInteger("-123456789012")) == -123456789012LL);
+  assert(static_cast<bool>(BigInteger(-5)) && !static_cast<bool>(BigInteger(0)));
+  assert(BigInteger("5") > BigInteger("-7"));
+
+  std::stringstream stream("-1000000000000000000000");
+  BigInteger read;
+  stream >> read;
+  assert(read == BigInteger("-1000") * BigInteger("1000000000000000000"));
+}
+
+// every multiplication path must agree with the schoolbook one
+void MultiplicationTest() {
+  std::mt19937_64 gen(42);
+  size_t karatsuba_threshold = BigInteger::karatsuba_threshold;
+  size_t toom3_threshold = BigInteger::toom3_threshold;
+  size_t ntt_threshold = BigInteger::ntt_threshold;
+  std::vector<std::tuple<size_t, size_t, size_t>> thresholds = {
+      {4, 1'000'000, 1'000'000}, {4, 4, 1'000'000}, {8, 20, 1'000'000}, {32, 300, 1'000'000}, {4, 4, 1}, {8, 20, 50}};
+  for (int test = 0; test < 200; ++test) {
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 3000);
+    BigInteger second = RandomBigInteger(gen, 1 + gen() % 3000);
+    if (test % 10 == 0) first = BigInteger(std::string(1 + gen() % 3000, '9'));
+    BigInteger::karatsuba_threshold = 1'000'000;
+    BigInteger expected = first * second;
+    for (auto [karatsuba, toom3, ntt] : thresholds) {
+      BigInteger::karatsuba_threshold = karatsuba;
+      BigInteger::toom3_threshold = toom3;
+      BigInteger::ntt_threshold = ntt;
+      assert(first * second == expected);
+    }
+    BigInteger::karatsuba_threshold = karatsuba_threshold;
+    BigInteger::toom3_threshold = toom3_threshold;
+    BigInteger::ntt_threshold = ntt_threshold;
+    if (second != 0) {
+      assert(expected / second == first);
+    }
+  }
+}
+
+void CheckDivision(const BigInteger& dividend, const BigInteger& divisor) {
+  BigInteger quotient = dividend / divisor;
+  BigInteger remainder = dividend % divisor;
+  assert(quotient * divisor + remainder == dividend);
+  assert(remainder.abs() < divisor.abs());
+  assert(remainder == 0 || (remainder < 0) == (dividend < 0));
+}
+
+void DivisionTest() {
+  std::mt19937_64 gen(13);
+  for (int test = 0; test < 300; ++test) {
+    BigInteger dividend = RandomBigInteger(gen, 1 + gen() % 2000);
+    BigInteger divisor = RandomBigInteger(gen, 1 + gen() % 1000);
+    CheckDivision(dividend, divisor);
+    CheckDivision(divisor, dividend);
+    CheckDivision(dividend * divisor + 1, divisor);
+    CheckDivision(dividend * divisor - 1, divisor);
+  }
+  // blocks of zero and one bits provoke corrections of the quotient digit estimate
+  std::vector<long long> patterns = {0, 1, 0xFFFFFFFF, 0x80000000, 0x7FFFFFFF, 0xFFFFFFFE};
+  BigInteger block_base = 0x100000000;
+  for (int test = 0; test < 2000; ++test) {
+    BigInteger dividend = 1;
+    BigInteger divisor = 1;
+    for (size_t i = gen() % 12; i > 0; --i) dividend = dividend * block_base + patterns[gen() % patterns.size()];
+    for (size_t i = gen() % 6; i > 0; --i) divisor = divisor * block_base + patterns[gen() % patterns.size()];
+    CheckDivision(dividend, divisor);
+  }
+  assert(BigInteger("1000000000000000000000000000") / BigInteger("999999999999999999") == 1000000000);
+  assert(BigInteger("340282366920938463463374607431768211455") / BigInteger("18446744073709551615")
+             == BigInteger("18446744073709551617"));
+  assert(BigInteger("-7") / 2 == -3);
+  assert(BigInteger("-7") % 2 == -1);
+}
+
+// Newton division must agree with algorithm D
+void NewtonDivisionTest() {
+  std::mt19937_64 gen(19);
+  size_t newton_threshold = BigInteger::newton_threshold;
+  for (int test = 0; test < 100; ++test) {
+    BigInteger dividend = RandomBigInteger(gen, 1 + gen() % 20'000);
+    BigInteger divisor = RandomBigInteger(gen, 1 + gen() % 10'000);
+    if (test % 10 == 0) divisor = BigInteger(std::string(1 + gen() % 10'000, '9'));
+    if (test % 10 == 1) divisor = BigInteger("1" + std::string(gen() % 10'000, '0'));
+    BigInteger::newton_threshold = 1'000'000;
+    BigInteger quotient = dividend / divisor;
+    BigInteger remainder = dividend % divisor;
+    for (size_t threshold : {1, 20, 100}) {
+      BigInteger::newton_threshold = threshold;
+      assert(dividend / divisor == quotient);
+      assert(dividend % divisor == remainder);
+    }
+  }
+  BigInteger::newton_threshold = newton_threshold;
+}
+
+// operators on expiring operands and the fused multiply-add must agree with the plain ones
+void MoveTest() {
+  std::mt19937_64 gen(31);
+  for (int test = 0; test < 300; ++test) {
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 200);
+    BigInteger second = RandomBigInteger(gen, 1 + gen() % 200);
+    BigInteger third = RandomBigInteger(gen, 1 + gen() % 200);
+    if (test % 10 == 0) second = first;
+    if (test % 10 == 1) second = -first;
+    const BigInteger& lvalue_1 = first;
+    const BigInteger& lvalue_2 = second;
+    BigInteger sum = lvalue_1 + lvalue_2;
+    BigInteger difference = lvalue_1 - lvalue_2;
+    BigInteger product = lvalue_1 * lvalue_2;
+    assert(BigInteger(first) + second == sum && first + BigInteger(second) == sum);
+    assert(BigInteger(first) + BigInteger(second) == sum);
+    assert(BigInteger(first) - second == difference && first - BigInteger(second) == difference);
+    assert(BigInteger(first) - BigInteger(second) == difference);
+    assert(BigInteger(first) * second == product && first * BigInteger(second) == product);
+    assert(BigInteger(first) * BigInteger(second) == product);
+    assert(BigInteger(product) / second == first && BigInteger(product) % second == 0);
+    assert(-BigInteger(first) == 0 - first);
+
+    BigInteger fused = third;
+    fused.add_mul(first, second);
+    assert(fused == third + product);
+    fused.sub_mul(first, second);
+    assert(fused == third);
+    fused.sub_mul(fused, fused);
+    assert(fused == third - third * third);
+
+    BigInteger copy = first;
+    BigInteger moved = std::move(first);
+    assert(first == 0 && moved == copy);
+  }
+  assert(Rational(1) / 3 + Rational(1) / 6 == Rational(1) / 2);
+  assert(Rational(1) / 3 - Rational(1) / 2 == Rational(-1) / 6);
+  assert((Rational(2) / 3 * (Rational(-3) / 4)).toString() == "-1/2");
+  assert((Rational(2) / (Rational(-3) / 4)).toString() == "-8/3");
+  assert(Rational().toString() == "0" && BigInteger().toString() == "0");
+}
+
+BigInteger EuclidGcd(BigInteger first, BigInteger second) {
+  first = first.abs();
+  second = second.abs();
+  while (second != 0) {
+    first %= second;
+    std::swap(first, second);
+  }
+  return first;
+}
+
+void GcdTest() {
+  std::mt19937_64 gen(41);
+  for (int test = 0; test < 300; ++test) {
+    BigInteger common = RandomBigInteger(gen, 1 + gen() % 300);
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 600) * common;
+    BigInteger second = RandomBigInteger(gen, 1 + gen() % 600) * common;
+    if (test % 10 == 0) second = first + 1;
+    if (test % 10 == 1) second = 0;
+    assert(gcd(first, second) == EuclidGcd(first, second));
+    assert(gcd(second, first) == EuclidGcd(first, second));
+  }
+  // consecutive Fibonacci numbers take the most Euclidean steps
+  BigInteger previous = 1;
+  BigInteger current = 1;
+  for (int i = 0; i < 5'000; ++i) {
+    previous += current;
+    std::swap(previous, current);
+  }
+  assert(gcd(current, previous) == 1);
+  assert(gcd(current * 6, previous * 4) == 2);
+  assert(gcd(0, 0) == 0);
+  assert(gcd(BigInteger("-18446744073709551615"), BigInteger("-36893488147419103230")) ==
+         BigInteger("18446744073709551615"));
+  assert((Rational(6) / Rational(-4)).toString() == "-3/2");
+}
+
+Rational RandomRational(std::mt19937_64& gen, size_t length) {
+  BigInteger denominator(RandomDigits(gen, length));
+  return Rational(RandomBigInteger(gen, length)) / Rational(denominator);
+}
+
+// lazy fractions must read the same as the eagerly reduced ones
+void LazyRationalTest() {
+  std::mt19937_64 gen(47);
+  size_t lazy_threshold = Rational::lazy_threshold;
+  for (int test = 0; test < 100; ++test) {
+    std::vector<Rational> values;
+    for (int i = 0; i < 20; ++i) values.push_back(RandomRational(gen, 1 + gen() % 20));
+    std::vector<int> operations;
+    for (int i = 0; i < 40; ++i) operations.push_back(int(gen() % 4));
+    auto run = [&] {
+      Rational result = 1;
+      for (size_t i = 0; i < operations.size(); ++i) {
+        const Rational& value = values[i % values.size()];
+        if (operations[i] == 0) result += value;
+        if (operations[i] == 1) result -= value;
+        if (operations[i] == 2) result *= value;
+        if (operations[i] == 3 && value != 0) result /= value;
+      }
+      return result;
+    };
+    Rational expected = run();
+    for (size_t threshold : {1, 64, 1'000'000}) {
+      Rational::lazy_threshold = threshold;
+      auto scope = Rational::lazy();
+      Rational result = run();
+      assert(result == expected);
+      assert(!(result < expected) && !(expected < result));
+      assert(result.toString() == expected.toString());
+    }
+  }
+  Rational::lazy_threshold = lazy_threshold;
+  {
+    auto scope = Rational::lazy();
+    Rational sum = 0;
+    for (int i = 0; i < 6; ++i) sum += Rational(1) / Rational(6);
+    assert(sum.toString() == "1");
+  }
+  assert((Rational(4) / 6 * (Rational(9) / 10)).toString() == "3/5");
+  assert((Rational(4) / 6 / (Rational(-10) / 9)).toString() == "-3/5");
+}
+
+// the digit by digit long division asDecimal used to do
+std::string SlowAsDecimal(const BigInteger& numerator, const BigInteger& denominator, size_t precision) {
+  std::string precised;
+  if (numerator < 0 && numerator / denominator == 0) precised += '-';
+  precised += (numerator / denominator).toString() + ".";
+  BigInteger rest = numerator.abs() % denominator;
+  for (size_t i = 0; i < precision; ++i) {
+    rest *= 10;
+    precised += (rest / denominator).toString();
+    rest %= denominator;
+  }
+  return precised;
+}
+
+void DecimalRationalTest() {
+  std::mt19937_64 gen(53);
+  for (int test = 0; test < 300; ++test) {
+    BigInteger numerator = RandomBigInteger(gen, 1 + gen() % 60);
+    BigInteger denominator(RandomDigits(gen, 1 + gen() % 60));
+    Rational number = Rational(numerator) / Rational(denominator);
+    BigInteger common = gcd(numerator, denominator);
+    size_t precision = gen() % 80;
+    assert(number.asDecimal(precision) == SlowAsDecimal(numerator / common, denominator / common, precision));
+  }
+  assert((Rational(-1) / 1000).asDecimal(2) == "-0.00");
+  assert((Rational(7) / 2).asDecimal() == "3.");
+
+  // both sides are exact or correctly rounded divisions of doubles
+  for (int test = 0; test < 1000; ++test) {
+    long long numerator = (long long) (gen() >> 11) - (1LL << 52);
+    long long denominator = (long long) (gen() >> (11 + gen() % 50)) + 1;
+    double expected = double(numerator) / double(denominator);
+    assert((Rational(BigInteger(numerator)) / Rational(BigInteger(denominator))).to_double() == expected);
+  }
+  BigInteger mantissa = (BigInteger(1) << 53) + 1;
+  assert(Rational(mantissa).to_double() == 9007199254740992.0);
+  assert(Rational(mantissa + 2).to_double() == 9007199254740996.0);
+  assert((Rational(1) / Rational(BigInteger(1) << 1074)).to_double() == std::ldexp(1.0, -1074));
+  assert((Rational(1) / Rational(BigInteger(1) << 1076)).to_double() == 0.0);
+  assert(Rational(BigInteger(3) << 2000).to_double() == HUGE_VAL);
+  assert(double(Rational(-3) / 4) == -0.75);
+
+  assert((BigInteger(5) << 70) >> 69 == 10);
+  assert(BigInteger(-5) >> 1 == -3 && BigInteger(-4) >> 1 == -2 && BigInteger(-1) >> 100 == -1);
+  assert((BigInteger("-36893488147419103232") >> 65) == -1 && (BigInteger(7) >> 3) == 0);
+}
+
+// every operation must match BigInteger reduced to Bits bits
+template<size_t Bits>
+void CheckFixedBigInteger(std::mt19937_64& gen) {
+  BigInteger modulo = BigInteger(1) << Bits;
+  BigInteger half = BigInteger(1) << (Bits - 1);
+  auto wrap = [&](BigInteger num) {
+    num %= modulo;
+    if (num < 0) num += modulo;
+    if (num >= half) num -= modulo;
+    return num;
+  };
+  std::vector<long long> patterns = {0, 1, 0xFFFFFFFF, 0x80000000, 0x7FFFFFFF};
+  auto random = [&] {
+    BigInteger num = 0;
+    for (size_t i = gen() % (Bits / 32 + 1); i > 0; --i) {
+      num <<= 32;
+      num += gen() % 2 ? patterns[gen() % patterns.size()] : (long long) (gen() >> 32);
+    }
+    return wrap(gen() % 2 ? -num : num);
+  };
+  for (int test = 0; test < 2'000; ++test) {
+    BigInteger first = random();
+    BigInteger second = random();
+    FixedBigInteger<Bits> fixed_first(first);
+    FixedBigInteger<Bits> fixed_second(second);
+    assert(BigInteger(fixed_first) == first && fixed_first.toString() == first.toString());
+    assert(FixedBigInteger<Bits>(first.toString()) == fixed_first);
+    assert(BigInteger(fixed_first + fixed_second) == wrap(first + second));
+    assert(BigInteger(fixed_first - fixed_second) == wrap(first - second));
+    assert(BigInteger(fixed_first * fixed_second) == wrap(first * second));
+    assert((fixed_first < fixed_second) == (first < second) && (fixed_first == fixed_second) == (first == second));
+    if (second != 0 && !(first == -half && second == -1)) {
+      assert(BigInteger(fixed_first / fixed_second) == first / second);
+      assert(BigInteger(fixed_first % fixed_second) == first % second);
+    }
+    size_t shift = gen() % (Bits + 10);
+    assert(BigInteger(fixed_first >> shift) == first >> shift);
+    assert(BigInteger(fixed_first << shift) == wrap(first << shift));
+  }
+}
+
+void FixedBigIntegerTest() {
+  std::mt19937_64 gen(61);
+  CheckFixedBigInteger<64>(gen);
+  CheckFixedBigInteger<96>(gen);
+  CheckFixedBigInteger<256>(gen);
+  CheckFixedBigInteger<512>(gen);
+
+  constexpr FixedBigInteger<128> quotient = FixedBigInteger<128>("-123456789012345678901234567") * 3 / 7;
+  static_assert(quotient == FixedBigInteger<128>("-52910052433862433814814814") && quotient % 10 == -4);
+  static_assert(FixedBigInteger<64>(9'223'372'036'854'775'807LL) + 1 < 0);
+  assert((FixedBigInteger<256>(1) << 255).toString() ==
+         "-57896044618658097711785492504343953926634992332820282019728792003956564819968");
+
+  std::stringstream stream("-340282366920938463463374607431768211455");
+  FixedBigInteger<192> read;
+  stream >> read;
+  std::stringstream output;
+  output << read;
+  assert(output.str() == "-340282366920938463463374607431768211455");
+
+  static_assert(FixedBigInteger<64>("+5") == 5);
+  for (const char* bad : {"", "-", "+", "12x4", "--5", " 7", "abc"}) {
+    bool is_rejected = false;
+    try {
+      FixedBigInteger<64> parsed(bad);
+    } catch (const std::invalid_argument&) {
+      is_rejected = true;
+    }
+    assert(is_rejected);
+  }
+  std::stringstream bad_stream("abc");
+  read = 7;
+  bad_stream >> read;
+  assert(bad_stream.fail() && read == 7);
+}
+
+// factorials up to 50! fit in 256 bits and are all worked out by the compiler
+constexpr std::array<FixedBigInteger<256>, 51> kFactorials = [] {
+  std::array<FixedBigInteger<256>, 51> result;
+  result[0] = 1;
+  for (int i = 1; i <= 50; ++i) result[i] = result[i - 1] * i;
+  return result;
+}();
+
+template<char... Digits>
+constexpr bool kIsBigIntegerLiteral = requires { operator""_bi<Digits...>(); };
+
+void LiteralTest() {
+  assert(123456789012345678901234_bi == BigInteger("123456789012345678901234"));
+  assert(0_bi == BigInteger(0) && 4'294'967'296_bi == BigInteger(4'294'967'296LL));
+  assert(-98765432109876543210_bi == BigInteger("-98765432109876543210"));
+  assert(0xFFFFFFFFFFFFFFFFFFFFFFFF_bi + 1 == 1_bi << 96);
+  assert(0b1010'1010_bi == 170 && 0755_bi == 493 && 0XaBcD_bi == 43981);
+  // 1.5_bi, 1e3_bi or 09_bi do not compile
+  static_assert(!kIsBigIntegerLiteral<'1', '.', '5'> && !kIsBigIntegerLiteral<'1', 'e', '3'>);
+  static_assert(!kIsBigIntegerLiteral<'0', '9'> && !kIsBigIntegerLiteral<'0', 'b', '2'>);
+  static_assert(kIsBigIntegerLiteral<'0', 'x', 'f', '\'', 'F'> && kIsBigIntegerLiteral<'0'>);
+  assert((1'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000'000_bi ==
+          BigInteger("1" + std::string(81, '0'))));
+  BigInteger literal =
+      31415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679_bi;
+  assert(literal.toString() ==
+         "31415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679");
+
+  static_assert(kFactorials[20] == FixedBigInteger<256>(2'432'902'008'176'640'000LL));
+  static_assert(kFactorials[50] / kFactorials[48] == 50 * 49);
+  static_assert(FixedBigInteger<256>("30414093201713378043612608166064768844377641568960512000000000000") ==
+                kFactorials[50]);
+  BigInteger factorial = 1;
+  for (int i = 1; i <= 50; ++i) {
+    factorial *= i;
+    assert(BigInteger(kFactorials[i]) == factorial);
+  }
+}
+
+BigInteger NaivePowMod(BigInteger num, BigInteger exponent, const BigInteger& mod) {
+  BigInteger result = 1;
+  num %= mod;
+  if (num < 0) num += mod;
+  while (exponent > 0) {
+    if (exponent % 2 == 1) {
+      result *= num;
+      result %= mod;
+    }
+    num *= num;
+    num %= mod;
+    exponent /= 2;
+  }
+  return result % mod;
+}
+
+void PowModTest() {
+  // 2^127 - 1 is prime
+  BigInteger prime = (1_bi << 127) - 1;
+  assert(BigInteger(3).pow_mod(prime - 1, prime) == 1);
+  assert(BigInteger(-5).pow_mod(prime - 1, prime) == 1);
+  assert(BigInteger(12345).pow_mod(0, 10) == 1 && BigInteger(12345).pow_mod(100, 1) == 0);
+  assert(BigInteger(2).pow_mod(100, 1'000'000'007) == 976'371'285);
+  // textbook RSA: p = 61, q = 53, e = 17, d = 2753
+  BigInteger::Modulus rsa(3233);
+  assert(rsa.pow(65, 17) == 2790 && rsa.pow(2790, 2753) == 65);
+  for (const BigInteger& mod : {BigInteger(3233), BigInteger(1)}) {
+    bool is_rejected = false;
+    try {
+      BigInteger(65).pow_mod(-1, mod);
+    } catch (const std::domain_error&) {
+      is_rejected = true;
+    }
+    assert(is_rejected);
+  }
+
+  std::mt19937_64 gen(71);
+  for (int i = 0; i < 300; ++i) {
+    BigInteger mod(RandomDigits(gen, 1 + gen() % 200));
+    if (i % 4 == 0) mod *= 2;
+    BigInteger num(RandomDigits(gen, 1 + gen() % 250));
+    if (i % 3 == 0) num = -num;
+    BigInteger exponent(RandomDigits(gen, 1 + gen() % 60));
+    assert(num.pow_mod(exponent, mod) == NaivePowMod(num, exponent, mod));
+  }
+}
+
+// products split among threads must agree with the single-threaded ones on every multiplication path
+void ParallelMultiplicationTest() {
+  std::mt19937_64 gen(79);
+  size_t karatsuba_threshold = BigInteger::karatsuba_threshold;
+  size_t toom3_threshold = BigInteger::toom3_threshold;
+  size_t ntt_threshold = BigInteger::ntt_threshold;
+  size_t parallel_threshold = BigInteger::parallel_threshold;
+  std::vector<std::tuple<size_t, size_t, size_t>> thresholds = {
+      {8, 1'000'000, 1'000'000}, {8, 20, 1'000'000}, {32, 300, 1'000'000}, {8, 20, 50}};
+  for (int test = 0; test < 40; ++test) {
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 20'000);
+    BigInteger second = RandomBigInteger(gen, 1 + gen() % 20'000);
+    if (test % 4 == 0) second = RandomBigInteger(gen, 1 + gen() % 2'000);
+    if (test % 10 == 0) first = second;
+    BigInteger expected = first * second;
+    for (auto [karatsuba, toom3, ntt] : thresholds) {
+      BigInteger::karatsuba_threshold = karatsuba;
+      BigInteger::toom3_threshold = toom3;
+      BigInteger::ntt_threshold = ntt;
+      for (size_t threads : {2, 3, 8}) {
+        BigInteger::thread_count = threads;
+        BigInteger::parallel_threshold = 16;
+        assert(first * second == expected);
+      }
+      BigInteger::thread_count = 1;
+      BigInteger::parallel_threshold = parallel_threshold;
+    }
+    BigInteger::karatsuba_threshold = karatsuba_threshold;
+    BigInteger::toom3_threshold = toom3_threshold;
+    BigInteger::ntt_threshold = ntt_threshold;
+  }
+  // the threads are kept between multiplications instead of being started for each parallel step
+  BigInteger first = RandomBigInteger(gen, 200'000);
+  BigInteger second = RandomBigInteger(gen, 200'000);
+  BigInteger expected = first * second;
+  BigInteger::thread_count = 8;
+  BigInteger::parallel_threshold = 16;
+  assert(first * second == expected && BigInteger::worker_threads() == 7);
+  assert(first * second == expected && BigInteger::worker_threads() == 7);
+  BigInteger::thread_count = 1;
+  BigInteger::parallel_threshold = parallel_threshold;
+}
+
+void ProductTest() {
+  std::mt19937_64 gen(89);
+  for (int test = 0; test < 100; ++test) {
+    std::vector<BigInteger> factors;
+    for (size_t i = gen() % 200; i > 0; --i) factors.push_back(RandomBigInteger(gen, 1 + gen() % 100));
+    BigInteger expected = 1;
+    for (const auto& factor : factors) expected *= factor;
+    assert(BigInteger::product(factors.begin(), factors.end()) == expected);
+  }
+  std::vector<int> small = {3, -4, 5};
+  assert(BigInteger::product(small.begin(), small.end()) == -60);
+  assert(BigInteger::product(small.begin(), small.begin()) == 1);
+
+  BigInteger factorial = 1;
+  for (size_t n = 0; n <= 600; ++n) {
+    if (n > 0) factorial *= BigInteger((long long) n);
+    assert(BigInteger::factorial(n) == factorial);
+  }
+  assert(BigInteger::factorial(25).toString() == "15511210043330985984000000");
+  for (size_t n = 0; n <= 60; ++n) {
+    BigInteger row = 1;
+    for (size_t k = 0; k <= n; ++k) {
+      assert(BigInteger::binomial(n, k) == row);
+      row *= BigInteger((long long) (n - k));
+      row /= BigInteger((long long) (k + 1));
+    }
+    assert(BigInteger::binomial(n, n + 1) == 0);
+  }
+  assert(BigInteger::binomial(3000, 1234) ==
+         BigInteger::factorial(3000) / (BigInteger::factorial(1234) * BigInteger::factorial(1766)));
+}
+
+// a number of the given amount of blocks, each of them random or one of the values that make carries run far
+BigInteger RandomBlocks(std::mt19937_64& gen, size_t blocks) {
+  const unsigned long long patterns[] = {0, 1, 0xFFFFFFFF, 0xFFFFFFFE, 0x80000000};
+  BigInteger result = 1;
+  for (size_t i = 0; i < blocks; ++i) {
+    result <<= 32;
+    result += (long long) (gen() % 3 == 0 ? gen() % 0x100000000 : patterns[gen() % 5]);
+  }
+  return result;
+}
+
+// the vectorized block kernels must agree with the scalar ones
+void VectorizedKernelTest() {
+  std::mt19937_64 gen(97);
+  for (int test = 0; test < 2000; ++test) {
+    BigInteger first = RandomBlocks(gen, gen() % 40);
+    BigInteger second = test % 3 == 0 ? first : RandomBlocks(gen, gen() % 40);
+    if (test % 3 == 0 && gen() % 2) second += (long long) (gen() % 3) - 1;
+    if (test % 5 == 0) second = -second;
+    BigInteger::vectorize = false;
+    BigInteger sum = first + second;
+    BigInteger difference = first - second;
+    bool less = first < second;
+    bool equal = first == second;
+    BigInteger::vectorize = true;
+    assert(first + second == sum && first - second == difference);
+    assert(sum - second == first && difference + second == first);
+    assert((first < second) == less && (first == second) == equal);
+  }
+}
+
+// the sign of the difference decides every comparison
+void ComparisonTest() {
+  std::mt19937_64 gen(103);
+  auto sign = [](const std::string& difference) {
+    return difference == "0" ? 0 : difference[0] == '-' ? -1 : 1;
+  };
+  for (int test = 0; test < 2000; ++test) {
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 40);
+    BigInteger second = test % 4 == 0 ? first + (long long) (gen() % 3) - 1 : RandomBigInteger(gen, 1 + gen() % 40);
+    if (test % 7 == 0) second = -first;
+    int expected = sign((first - second).toString());
+    assert(first.compare(second) == expected && second.compare(first) == -expected);
+    assert((first <=> second) == (expected <=> 0));
+    assert((first < second) == (expected < 0) && (first <= second) == (expected <= 0));
+    assert((first > second) == (expected > 0) && (first >= second) == (expected >= 0));
+    assert((first == second) == (expected == 0) && (first != second) == (expected != 0));
+  }
+  for (int test = 0; test < 2000; ++test) {
+    Rational first = RandomRational(gen, 1 + gen() % 30);
+    Rational second = test % 4 == 0 ? first * Rational(int(gen() % 5) - 2) : RandomRational(gen, 1 + gen() % 30);
+    if (test % 5 == 0) second = first + Rational(1) / BigInteger(RandomDigits(gen, 1 + gen() % 60));
+    if (test % 9 == 0) second = Rational(BigInteger(RandomDigits(gen, 1 + gen() % 30)));
+    if (test % 11 == 0) {
+      // the same value with an unreduced denominator
+      auto scope = Rational::lazy();
+      second = first * Rational(7) / 7;
+    }
+    int expected = sign((first - second).toString());
+    assert(first.compare(second) == expected && second.compare(first) == -expected);
+    assert((first <=> second) == (expected <=> 0));
+    assert((first < second) == (expected < 0) && (first <= second) == (expected <= 0));
+    assert((first > second) == (expected > 0) && (first >= second) == (expected >= 0));
+    assert((first == second) == (expected == 0) && (first != second) == (expected != 0));
+  }
+}
+
+void BitwiseTest() {
+  std::mt19937_64 gen(109);
+  for (int test = 0; test < 2000; ++test) {
+    long long first = (long long) (gen() >> (gen() % 64)) >> 1;
+    long long second = (long long) (gen() >> (gen() % 64)) >> 1;
+    if (gen() % 2) first = -first;
+    if (gen() % 2) second = -second;
+    assert((BigInteger(first) & BigInteger(second)) == (first & second));
+    assert((BigInteger(first) | BigInteger(second)) == (first | second));
+    assert((BigInteger(first) ^ BigInteger(second)) == (first ^ second));
+    assert(~BigInteger(first) == ~first);
+    size_t shift = gen() % 63;
+    assert((BigInteger(first) >> shift) == first >> shift);
+    assert(BigInteger(first).popcount() == size_t(std::popcount(uint64_t(first < 0 ? -first : first))));
+  }
+  for (int test = 0; test < 500; ++test) {
+    BigInteger first = RandomBigInteger(gen, 1 + gen() % 200);
+    BigInteger second = RandomBigInteger(gen, 1 + gen() % 200);
+    size_t shift = gen() % 700;
+    BigInteger power = BigInteger(1) << shift;
+    assert((first & second) + (first | second) == first + second);
+    assert((first ^ second) == (first | second) - (first & second));
+    assert((first & ~first) == 0 && (first | ~first) == -1 && (first ^ first) == 0);
+    assert(~~first == first && (~first & second) == (second & ~first));
+    // the low bits of a negative number are its remainder rounded towards minus infinity
+    BigInteger low = first & (power - 1);
+    assert(low >= 0 && low < power && (first - low) % power == 0);
+    assert((first >> shift) == (first - low) / power && (first << shift) == first * power);
+    assert(((first.abs() | power).popcount() == first.popcount() + 1) == ((first.abs() & power) == 0));
+  }
+}
+
+BigInteger Power(const BigInteger& base, size_t exponent) {
+  BigInteger result = 1;
+  for (size_t i = 0; i < exponent; ++i) result *= base;
+  return result;
+}
+
+// the root by bisection, one multiplication per bit
+BigInteger BisectionRoot(const BigInteger& num, size_t n) {
+  BigInteger low = 0;
+  BigInteger high = BigInteger(1) << (num.bit_length() / n + 1);
+  while (high - low > 1) {
+    BigInteger middle = (low + high) >> 1;
+    if (Power(middle, n) <= num) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void RootTest() {
+  std::mt19937_64 gen(127);
+  for (long long num = 0; num <= 3000; ++num) {
+    bool is_square = false;
+    bool is_power = num <= 1;
+    for (long long root = 0; root * root <= num; ++root) is_square = is_square || root * root == num;
+    for (long long root = 2; root * root <= num; ++root) {
+      for (long long power = root * root; power <= num; power *= root) is_power = is_power || power == num;
+    }
+    assert(BigInteger(num).is_perfect_square() == is_square);
+    assert(BigInteger(num).is_perfect_power() == is_power);
+    assert(BigInteger(num).isqrt() == BisectionRoot(num, 2) && BigInteger(num).iroot(3) == BisectionRoot(num, 3));
+  }
+  for (int test = 0; test < 300; ++test) {
+    BigInteger num(RandomDigits(gen, 1 + gen() % 1500));
+    BigInteger root = num.isqrt();
+    assert(root * root <= num && (root + 1) * (root + 1) > num);
+    BigInteger square = root * root;
+    assert(square.is_perfect_square() && square.isqrt() == root && (square - 1).isqrt() == root - 1);
+    assert(!(square + 1).is_perfect_square() && (square - 1 == 0 || !(square - 1).is_perfect_square()));
+    size_t n = 3 + gen() % 20;
+    if (test % 10 == 0) n = 2 + gen() % (num.bit_length() + 2);
+    root = num.iroot(n);
+    assert(Power(root, n) <= num && Power(root + 1, n) > num);
+    BigInteger power = Power(root + 2, n);
+    assert(power.iroot(n) == root + 2 && (power - 1).iroot(n) == root + 1 && power.is_perfect_power());
+  }
+  BigInteger base(RandomDigits(gen, 100));
+  assert(Power(base, 35).is_perfect_power() && !(Power(base, 35) + 1).is_perfect_power());
+  assert((BigInteger(1) << 1001).is_perfect_power() && (BigInteger(3) << 1000).is_perfect_power() == false);
+  auto is_rejected = [](auto root) {
+    try {
+      root();
+    } catch (const std::domain_error&) {
+      return true;
+    }
+    return false;
+  };
+  BigInteger negative("-1" + std::string(30, '0'));
+  assert(is_rejected([] { BigInteger(1000).iroot(0); }));
+  assert(is_rejected([] { BigInteger(-5).isqrt(); }) && is_rejected([&] { negative.isqrt(); }));
+  assert(is_rejected([] { BigInteger(-27).iroot(3); }) && is_rejected([&] { negative.iroot(5); }));
+  assert(BigInteger(0).isqrt() == 0 && BigInteger(0).iroot(3) == 0);
+  assert(!BigInteger(-4).is_perfect_square() && !negative.is_perfect_square());
+  assert(!BigInteger(-1).is_perfect_power() && !BigInteger(-8).is_perfect_power() && !negative.is_perfect_power());
+}
+
+void SerializationTest() {
+  std::mt19937_64 gen(137);
+  std::vector<BigInteger> numbers = {0, 1, -1, BigInteger(-0x0102030405LL)};
+  for (int i = 0; i < 300; ++i) numbers.push_back(RandomBigInteger(gen, 1 + gen() % 500));
+  size_t size = 0;
+  for (const auto& num : numbers) size += num.serialized_size();
+  std::vector<std::byte> buffer(size);
+  size_t offset = 0;
+  for (const auto& num : numbers) offset += num.serialize(std::span(buffer).subspan(offset));
+  assert(offset == size);
+
+  // -0x0102030405: version, sign, two zero bytes, two blocks, then the blocks
+  const unsigned char expected[] = {1, 1, 0, 0, 2, 0, 0, 0, 5, 4, 3, 2, 1, 0, 0, 0};
+  size_t start = numbers[0].serialized_size() + numbers[1].serialized_size() + numbers[2].serialized_size();
+  assert(std::memcmp(buffer.data() + start, expected, sizeof(expected)) == 0);
+
+  offset = 0;
+  for (const auto& num : numbers) {
+    BigInteger read = BigInteger::deserialize(std::span(buffer).subspan(offset));
+    BigIntegerView view{std::span(buffer).subspan(offset)};
+    assert(read == num && view.value() == num && view.is_negative() == (num < 0));
+    assert(view.blocks().size() * 32 >= num.bit_length() && view.size() == num.serialized_size());
+    offset += view.size();
+  }
+
+  auto fails = [](std::span<const std::byte> record) {
+    try {
+      BigInteger::deserialize(record);
+    } catch (const std::invalid_argument&) {
+      return true;
+    }
+    return false;
+  };
+  std::vector<std::byte> record(numbers.back().serialized_size());
+  numbers.back().serialize(record);
+  assert(!fails(record) && fails(std::span(record).first(record.size() - 1)) && fails(std::span(record).first(4)));
+  record[0] = std::byte{2};
+  assert(fails(record));
+  bool is_short = false;
+  try {
+    numbers.back().serialize(std::span(record).first(8));
+  } catch (const std::length_error&) {
+    is_short = true;
+  }
+  assert(is_short);
+
+  for (int test = 0; test < 100; ++test) {
+    Rational fraction = RandomRational(gen, 1 + gen() % 100);
+    std::vector<std::byte> bytes(fraction.serialized_size());
+    assert(fraction.serialize(bytes) == bytes.size());
+    assert(Rational::deserialize(bytes) == fraction);
+  }
+  // a record of 2/4 comes back reduced, and a zero denominator is rejected
+  auto fraction_record = [](const BigInteger& numerator, const BigInteger& denominator) {
+    std::vector<std::byte> bytes(numerator.serialized_size() + denominator.serialized_size());
+    numerator.serialize(bytes);
+    denominator.serialize(std::span(bytes).subspan(numerator.serialized_size()));
+    return bytes;
+  };
+  Rational half = Rational::deserialize(fraction_record(2, 4));
+  assert(half == Rational(1) / Rational(2) && half.compare(Rational(1) / Rational(2)) == 0);
+  assert(half.toString() == "1/2");
+  bool is_rejected = false;
+  try {
+    Rational::deserialize(fraction_record(2, 0));
+  } catch (const std::invalid_argument&) {
+    is_rejected = true;
+  }
+  assert(is_rejected);
+}
+
+// the stream reader must agree with the string constructor around the chunk sizes
+void StreamReadTest() {
+  std::mt19937_64 gen(149);
+  std::vector<std::string> tokens = {"0", "-0", "000123", "-000", "4294967296", "-18446744073709551616"};
+  for (size_t chunks : {1, 2, 3, 4, 7}) {
+    for (long long delta : {-1, 0, 1}) tokens.push_back(RandomDigits(gen, size_t(4608 * chunks + delta)));
+  }
+  for (int i = 0; i < 30; ++i) tokens.push_back((gen() % 2 ? "-" : "") + RandomDigits(gen, 1 + gen() % 40'000));
+  std::string text = "  ";
+  for (const auto& token : tokens) text += token + (gen() % 2 ? "\n" : " \t ");
+  std::stringstream stream(text);
+  for (const auto& token : tokens) {
+    BigInteger read;
+    stream >> read;
+    assert(stream && read == BigInteger(token));
+  }
+  BigInteger read = 5;
+  stream >> read;
+  assert(stream.fail() && stream.eof());
+
+  std::stringstream tail("123abc -x");
+  tail >> read;
+  assert(tail && read == 123 && tail.peek() == 'a');
+  std::string word;
+  tail >> word >> read;
+  assert(word == "abc" && tail.fail());
+  std::stringstream end("-987654321987654321987654321");
+  end >> read;
+  assert(!end.fail() && end.eof() && read == BigInteger("-987654321987654321987654321"));
+
+  std::stringstream plus("+42 -abc +");
+  plus >> read;
+  assert(plus && read == 42);
+  plus >> read;
+  assert(plus.fail());
+  plus.clear();
+  assert(plus.peek() == '-' && plus >> word && word == "-abc");
+  plus >> read;
+  assert(plus.fail());
+  plus.clear();
+  assert(plus.peek() == '+');
+}
+
+void PoolTest() {
+  bool enabled = BlockPool::enabled;
+  size_t limit = BlockPool::limit;
+  std::mt19937_64 gen(23);
+  std::vector<BigInteger> values;
+  for (size_t length : {1, 5, 40, 300, 3000}) {
+    values.push_back(RandomBigInteger(gen, length));
+    values.push_back(-RandomBigInteger(gen, length));
+  }
+  std::vector<BigInteger> expected;
+  BlockPool::enabled = false;
+  for (const BigInteger& a : values) {
+    for (const BigInteger& b : values) {
+      expected.push_back(a * b + a - b);
+      expected.push_back(b == 0 ? a : a / b);
+    }
+  }
+  BlockPool::enabled = true;
+  size_t index = 0;
+  for (const BigInteger& a : values) {
+    for (const BigInteger& b : values) {
+      assert(a * b + a - b == expected[index++]);
+      assert((b == 0 ? a : a / b) == expected[index++]);
+    }
+  }
+  assert(BlockPool::cached() <= BlockPool::limit);
+
+  // once warmed up, the temporaries of a repeated expression come from the free lists
+  BigInteger a = values[4];
+  BigInteger b = values[5];
+  BigInteger c = values[6];
+  BigInteger result = a * b - c * a;
+  size_t before = allocations;
+  for (int i = 0; i < 100; ++i) {
+    result = a * b - c * a;
+  }
+  assert(allocations == before);
+  assert(result == a * b - c * a);
+
+  // blocks released while disabled or over the limit go back to the heap
+  BlockPool::trim();
+  assert(BlockPool::cached() == 0);
+  BlockPool::limit = 0;
+  result = a * b;
+  result = 0;
+  assert(BlockPool::cached() == 0);
+  BlockPool::limit = limit;
+  BlockPool::enabled = false;
+  result = a * b;
+  result = 0;
+  assert(BlockPool::cached() == 0);
+
+  // blocks may be released by another thread than the one that allocated them
+  BlockPool::enabled = true;
+  std::vector<BigInteger> products(8);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < products.size(); ++i) {
+    workers.emplace_back([&, i] { products[i] = values[i] * values[i + 1]; });
+  }
+  for (std::thread& worker : workers) worker.join();
+  for (size_t i = 0; i < products.size(); ++i) {
+    assert(products[i] == values[i] * values[i + 1]);
+  }
+  products.clear();
+
+  BlockPool::trim();
+  BlockPool::enabled = enabled;
+}
+
+void StatsTest() {
+  using Operation = BigIntegerStats::Operation;
+  std::mt19937_64 gen(24);
+  BigInteger small = RandomBigInteger(gen, 50);
+  BigInteger medium = RandomBigInteger(gen, 2000);
+  BigInteger large = RandomBigInteger(gen, 20000);
+  BigIntegerStats::reset();
+  BigInteger product = small * small;
+  product = medium * medium;
+  product = large * large;
+  product = large * medium;
+  BigInteger quotient = large / medium;
+  BigInteger divisor = gcd(large, medium);
+  BigInteger copy = large;
+  // the sum is reduced by one Rational::shrink
+  Rational fraction = Rational(1) / Rational(3);
+  fraction += Rational(large);
+  std::stringstream dump;
+  BigIntegerStats::dump_stats(dump);
+  if constexpr (BigIntegerStats::enabled) {
+    assert(BigIntegerStats::calls(Operation::schoolbook) >= 2);
+    assert(BigIntegerStats::calls(Operation::karatsuba) >= 1);
+    assert(BigIntegerStats::calls(Operation::unbalanced) >= 1);
+    assert(BigIntegerStats::calls(Operation::division) >= 1);
+    assert(BigIntegerStats::calls(Operation::gcd) >= 2);
+    assert(BigIntegerStats::calls(Operation::copy) >= 1);
+    assert(BigIntegerStats::calls(Operation::allocation) + BigIntegerStats::calls(Operation::pool_hit) >= 4);
+    // the copy of large is counted with its length in the bucket of its bit width
+    size_t length = large.serialized_size() / 4 - 2;
+    assert(BigIntegerStats::histogram(Operation::copy, std::bit_width(length)) >= 1);
+    assert(BigIntegerStats::limbs(Operation::copy) >= length);
+    assert(dump.str().find("karatsuba: ") != std::string::npos);
+    assert(BigIntegerStats::calls(Operation::shrink) == 1);
+    assert(dump.str().find("shrink: 1 calls") != std::string::npos);
+    assert(dump.str().find("copy: ") != std::string::npos && dump.str().find(" bytes)") != std::string::npos);
+    BigIntegerStats::reset();
+    for (size_t i = 0; i < size_t(Operation::count); ++i) {
+      assert(BigIntegerStats::calls(Operation(i)) == 0);
+    }
+  } else {
+    for (size_t i = 0; i < size_t(Operation::count); ++i) {
+      assert(BigIntegerStats::calls(Operation(i)) == 0);
+      assert(BigIntegerStats::limbs(Operation(i)) == 0);
+    }
+    assert(dump.str().find("disabled") != std::string::npos);
+  }
+}
+
+void FusedExpressionTest() {
+  std::mt19937_64 gen(25);
+  for (size_t length : {1, 9, 30, 200, 1500, 7000}) {
+    for (int round = 0; round < 10; ++round) {
+      BigInteger a = RandomBigInteger(gen, 1 + gen() % length);
+      BigInteger b = RandomBigInteger(gen, 1 + gen() % length);
+      BigInteger c = RandomBigInteger(gen, 1 + gen() % length);
+      BigInteger d = RandomBigInteger(gen, 1 + gen() % length);
+      BigInteger e = RandomBigInteger(gen, 1 + gen() % length);
+      BigInteger expected = a * b + c * d - e;
+      BigInteger result = fused(a) * b + fused(c) * d - e;
+      assert(result == expected);
+      result = e - fused(a) * b - c * fused(d) + fused(e);
+      assert(result == e - a * b - c * d + e);
+      result = -(fused(a) * b) + a;
+      assert(result == a - a * b);
+      assert(BigInteger(fused(a) * fused(b)) == a * b);
+      // a product of three factors is evaluated eagerly past the first two
+      assert(fused(a) * b * c == a * b * c);
+      // the destination may be one of the operands
+      result = a;
+      result = fused(result) * b - fused(result) * c + result;
+      assert(result == a * b - a * c + a);
+      result = c;
+      result += fused(a) * b;
+      assert(result == c + a * b);
+      result -= fused(result) * d;
+      assert(result == (c + a * b) - (c + a * b) * d);
+    }
+  }
+  BigInteger a("123456789012345678901234567890");
+  BigInteger zero;
+  assert((BigInteger(fused(a) * a - fused(a) * a)).toString() == "0");
+  assert(BigInteger(fused(a) * a - fused(a) * a).sign() == 0);
+  assert(BigInteger(fused(zero) * a + zero) == 0);
+  assert(BigInteger(-fused(a)) == -a);
+
+  // Rational addition goes through the fused layer
+  Rational sum;
+  for (int i = 1; i <= 10; ++i) sum += Rational(1) / Rational(i);
+  assert(sum.toString() == "7381/2520");
+  sum -= Rational(7381) / Rational(2520);
+  assert(sum == Rational(0));
+  Rational self = Rational(3) / Rational(4);
+  self += self;
+  assert(self == Rational(3) / Rational(2));
+  self -= self;
+  assert(self == Rational(0));
+}
+
+void MultiplicationPerformanceTest() {
+  std::mt19937_64 gen(7);
+  size_t karatsuba_threshold = BigInteger::karatsuba_threshold;
+  for (size_t digits : {1'000, 10'000, 100'000}) {
+    BigInteger first(RandomDigits(gen, digits));
+    BigInteger second(RandomDigits(gen, digits));
+    int repeats = int(std::max<size_t>(1, 100'000'000 / (digits * digits)));
+    BigInteger::karatsuba_threshold = 1'000'000;
+    double schoolbook = Measure([&] { first * second; }, repeats);
+    BigInteger::karatsuba_threshold = karatsuba_threshold;
+    double fast = Measure([&] { first * second; }, repeats);
+    std::cerr << " " << digits << " digits: schoolbook " << schoolbook << " ms, Karatsuba/Toom-3 " << fast << " ms"
+              << std::endl;
+  }
+}
+
+// the largest products have every NTT coefficient near its bound
+void NttTest() {
+  size_t ntt_threshold = BigInteger::ntt_threshold;
+  BigInteger nines(std::string(9 * 40'000, '9'));
+  BigInteger::ntt_threshold = 1'000'000;
+  BigInteger expected = nines * nines;
+  BigInteger::ntt_threshold = 1;
+  assert(nines * nines == expected);
+  assert(nines * (nines - 1) == expected - nines);
+  BigInteger::ntt_threshold = ntt_threshold;
+}
+
+// divide-and-conquer conversion must agree with the schoolbook one in both directions
+void DecimalConversionTest() {
+  std::mt19937_64 gen(23);
+  // the caches of powers of 10 and their reciprocals are shared and grow from two threads at once
+  {
+    std::string digits[2] = {RandomDigits(gen, 200'000), RandomDigits(gen, 200'000)};
+    std::string outputs[2];
+    std::thread other([&] { outputs[1] = BigInteger(digits[1]).toString(); });
+    outputs[0] = BigInteger(digits[0]).toString();
+    other.join();
+    assert(outputs[0] == digits[0] && outputs[1] == digits[1]);
+  }
+  size_t decimal_threshold = BigInteger::decimal_threshold;
+  for (int test = 0; test < 100; ++test) {
+    std::string digits = RandomDigits(gen, 1 + gen() % 5'000);
+    if (test % 10 == 0) digits = std::string(1 + gen() % 5'000, '9');
+    if (test % 10 == 1) digits = "1" + std::string(gen() % 5'000, '0');
+    if (test % 2 == 0) digits.insert(digits.begin(), '-');
+    BigInteger::decimal_threshold = 1'000'000;
+    BigInteger expected(digits);
+    assert(expected.toString() == digits);
+    for (size_t threshold : {1, 2, 5}) {
+      BigInteger::decimal_threshold = threshold;
+      BigInteger number(digits);
+      assert(number == expected);
+      std::string output = "reused";
+      number.toString(output);
+      assert(output == digits);
+    }
+  }
+  BigInteger::decimal_threshold = decimal_threshold;
+  assert(BigInteger("000123").toString() == "123");
+  assert(BigInteger("-000").toString() == "0");
+  assert(BigInteger("+5") == 5 && BigInteger("+0").toString() == "0");
+  for (const char* text : {"12x4", "+", "-", "", "--5", "+-5", " 5", "5 ", "1.5"}) {
+    bool is_rejected = false;
+    try {
+      BigInteger number(text);
+    } catch (const std::invalid_argument&) {
+      is_rejected = true;
+    }
+    assert(is_rejected);
+  }
+}
+
+void DivisionPerformanceTest() {
+  std::mt19937_64 gen(17);
+  size_t newton_threshold = BigInteger::newton_threshold;
+  for (size_t digits : {1'000, 10'000, 30'000, 100'000}) {
+    BigInteger dividend(RandomDigits(gen, 2 * digits));
+    BigInteger divisor(RandomDigits(gen, digits));
+    BigInteger::newton_threshold = 1'000'000;
+    double knuth = Measure([&] { dividend / divisor; });
+    BigInteger::newton_threshold = 1;
+    double newton = Measure([&] { dividend / divisor; });
+    BigInteger::newton_threshold = newton_threshold;
+    std::cerr << " " << 2 * digits << " / " << digits << " digits: algorithm D " << knuth << " ms, Newton " << newton
+              << " ms" << std::endl;
+  }
+}
+
+void DecimalConversionPerformanceTest() {
+  std::mt19937_64 gen(29);
+  size_t decimal_threshold = BigInteger::decimal_threshold;
+  for (size_t digits : {10'000, 100'000, 1'000'000}) {
+    std::string input = RandomDigits(gen, digits);
+    std::string output;
+    BigInteger number(input);
+    double parse = Measure([&] { BigInteger parsed(input); });
+    double print = Measure([&] { number.toString(output); });
+    std::cerr << " " << digits << " digits: parse " << parse << " ms, toString " << print << " ms";
+    if (digits <= 100'000) {
+      BigInteger::decimal_threshold = 1'000'000;
+      parse = Measure([&] { BigInteger parsed(input); });
+      print = Measure([&] { number.toString(output); });
+      BigInteger::decimal_threshold = decimal_threshold;
+      std::cerr << " (schoolbook " << parse << " ms, " << print << " ms)";
+    }
+    std::cerr << std::endl;
+  }
+}
+
+// small fractions keep every BigInteger within a few blocks
+void RationalAllocationPerformanceTest() {
+  std::vector<Rational> values;
+  for (int i = 1; i <= 100; ++i) {
+    values.push_back(Rational(i % 2 ? i % 13 + 1 : -(i % 11 + 1)) / Rational(i % 7 + 1));
+  }
+  size_t operations = 0;
+  size_t before = allocations;
+  Rational result;
+  double time = Measure([&] {
+    for (size_t i = 0; i < values.size(); ++i) {
+      for (size_t j = 0; j < values.size(); ++j) {
+        result = values[i] + values[j];
+        result = values[i] - values[j];
+        result = values[i] * values[j];
+        result = values[i] / values[j];
+        operations += 4 + (values[i] < values[j]);
+      }
+    }
+  });
+  std::cerr << " Rational arithmetic: " << double(allocations - before) / double(operations)
+            << " allocations per operation, " << time * 1e6 / double(operations) << " ns per operation" << std::endl;
+}
+
+// temporaries of chained expressions on numbers of a few hundred digits
+void ExpressionAllocationPerformanceTest() {
+  std::mt19937_64 gen(37);
+  std::vector<BigInteger> values;
+  for (int i = 0; i < 50; ++i) values.push_back(RandomBigInteger(gen, 500));
+  size_t before = allocations;
+  BigInteger result;
+  double time = Measure([&] {
+    for (size_t i = 0; i + 2 < values.size(); ++i) {
+      result = values[i] * values[i + 1] + values[i + 2] - values[i] * values[i + 2];
+    }
+  }, 100);
+  size_t expressions = 100 * (values.size() - 2);
+  std::cerr << " a * b + c - a * c: " << double(allocations - before) / double(expressions)
+            << " allocations, " << time * 1e3 / double(values.size() - 2) << " us per expression" << std::endl;
+  before = allocations;
+  Rational harmonic;
+  time = Measure([&] {
+    harmonic = 0;
+    for (int i = 1; i <= 300; ++i) harmonic += Rational(1) / Rational(i);
+  });
+  std::cerr << " harmonic sum of 300 terms: " << allocations - before << " allocations, " << time << " ms"
+            << std::endl;
+}
+
+void GcdPerformanceTest() {
+  std::mt19937_64 gen(43);
+  for (size_t digits : {1'000, 10'000, 100'000}) {
+    BigInteger common(RandomDigits(gen, digits / 10));
+    BigInteger first = BigInteger(RandomDigits(gen, digits)) * common;
+    BigInteger second = BigInteger(RandomDigits(gen, digits)) * common;
+    double lehmer = Measure([&] { gcd(first, second); });
+    std::cerr << " " << digits << " digits: Lehmer " << lehmer << " ms";
+    if (digits <= 10'000) {
+      std::cerr << ", Euclid " << Measure([&] { EuclidGcd(first, second); }) << " ms";
+    }
+    std::cerr << std::endl;
+  }
+}
+
+void LazyRationalPerformanceTest() {
+  std::vector<Rational> values;
+  for (int i = 1; i <= 60; ++i) values.push_back(Rational(i % 13 + 1) / Rational(i % 11 + 2));
+  auto products = [&] {
+    Rational sum;
+    for (const Rational& first : values) {
+      for (const Rational& second : values) sum += first * second;
+    }
+    sum.normalize();
+  };
+  auto harmonic = [&] {
+    Rational sum;
+    for (int i = 1; i <= 300; ++i) sum += Rational(1) / Rational(i);
+    sum.normalize();
+  };
+  double eager_products = Measure(products, 3);
+  double eager_harmonic = Measure(harmonic, 3);
+  auto scope = Rational::lazy();
+  std::cerr << " 3600 products: eager " << eager_products << " ms, lazy " << Measure(products, 3) << " ms" << std::endl;
+  std::cerr << " harmonic sum of 300 terms: eager " << eager_harmonic << " ms, lazy " << Measure(harmonic, 3)
+            << " ms" << std::endl;
+}
+
+void DecimalRationalPerformanceTest() {
+  std::mt19937_64 gen(59);
+  std::vector<Rational> values;
+  std::vector<std::pair<BigInteger, BigInteger>> fractions;
+  for (int i = 0; i < 2'000; ++i) {
+    BigInteger numerator = RandomBigInteger(gen, 30);
+    BigInteger denominator(RandomDigits(gen, 30));
+    values.push_back(Rational(numerator) / Rational(denominator));
+    fractions.emplace_back(numerator, denominator);
+  }
+  double slow = Measure([&] {
+    for (auto& [numerator, denominator] : fractions) SlowAsDecimal(numerator, denominator, 50);
+  });
+  double fast = Measure([&] {
+    for (const Rational& value : values) value.asDecimal(50);
+  });
+  double to_double = Measure([&] {
+    for (const Rational& value : values) value.to_double();
+  });
+  std::cerr << " 2000 rationals to 50 digits: digit by digit " << slow << " ms, single division " << fast
+            << " ms, to_double " << to_double << " ms" << std::endl;
+}
+
+void FixedBigIntegerPerformanceTest() {
+  std::mt19937_64 gen(67);
+  std::vector<BigInteger> values;
+  std::vector<FixedBigInteger<512>> fixed_values;
+  for (int i = 0; i < 1'000; ++i) {
+    values.push_back(RandomBigInteger(gen, 35));
+    fixed_values.emplace_back(values.back());
+  }
+  size_t before = allocations;
+  BigInteger sum = 0;
+  double dynamic = Measure([&] {
+    for (size_t i = 0; i + 1 < values.size(); ++i) sum += values[i] * values[i + 1] % values[0];
+  }, 10);
+  size_t dynamic_allocations = allocations - before;
+  before = allocations;
+  FixedBigInteger<512> fixed_sum = 0;
+  double fixed = Measure([&] {
+    for (size_t i = 0; i + 1 < fixed_values.size(); ++i) fixed_sum += fixed_values[i] * fixed_values[i + 1] % fixed_values[0];
+  }, 10);
+  assert(BigInteger(fixed_sum) == sum);
+  std::cerr << " 1000 products of 35 digits modulo another: BigInteger " << dynamic << " ms (" << dynamic_allocations
+            << " allocations), FixedBigInteger<512> " << fixed << " ms (" << allocations - before << " allocations)"
+            << std::endl;
+}
+
+void LiteralPerformanceTest() {
+  const std::string digits = "123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890";
+  BigInteger sum = 0;
+  double parsed = Measure([&] {
+    for (int i = 0; i < 10'000; ++i) sum += BigInteger(digits);
+  }, 10);
+  double literal = Measure([&] {
+    for (int i = 0; i < 10'000; ++i) {
+      sum -= 123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890_bi;
+    }
+  }, 10);
+  assert(sum == 0);
+  std::cerr << " 10000 constants of 90 digits: parsed " << parsed << " ms, _bi literal " << literal << " ms"
+            << std::endl;
+}
+
+void PowModPerformanceTest() {
+  std::mt19937_64 gen(73);
+  for (size_t bits : {2048, 4096}) {
+    BigInteger mod(RandomDigits(gen, DigitsForBlocks(bits / 32)));
+    if (mod % 2 == 0) ++mod;
+    BigInteger num = BigInteger(RandomDigits(gen, DigitsForBlocks(bits / 32))) % mod;
+    BigInteger exponent(RandomDigits(gen, DigitsForBlocks(bits / 32)));
+    BigInteger expected;
+    double naive = Measure([&] { expected = NaivePowMod(num, exponent, mod); }, 1);
+    BigInteger result;
+    double montgomery = Measure([&] { result = num.pow_mod(exponent, mod); }, 3);
+    assert(result == expected);
+    BigInteger::Modulus context(mod);
+    double reused = Measure([&] { result = context.pow(num, exponent); }, 3);
+    assert(result == expected);
+    std::cerr << " " << bits << "-bit a^e mod m: *= and %= " << naive << " ms, pow_mod " << montgomery
+              << " ms, reused Modulus " << reused << " ms" << std::endl;
+  }
+}
+
+void NttPerformanceTest() {
+  std::mt19937_64 gen(11);
+  size_t karatsuba_threshold = BigInteger::karatsuba_threshold;
+  size_t ntt_threshold = BigInteger::ntt_threshold;
+  size_t crossover = 0;
+  for (size_t blocks = 16; blocks <= 8'192; blocks *= 2) {
+    BigInteger first(RandomDigits(gen, DigitsForBlocks(blocks)));
+    BigInteger second(RandomDigits(gen, DigitsForBlocks(blocks)));
+    int repeats = int(std::max<size_t>(1, 1'000'000 / (blocks * blocks)));
+    BigInteger::karatsuba_threshold = 1'000'000;
+    double schoolbook = Measure([&] { first * second; }, repeats);
+    BigInteger::karatsuba_threshold = karatsuba_threshold;
+    BigInteger::ntt_threshold = 1'000'000;
+    double toom3 = Measure([&] { first * second; }, repeats);
+    BigInteger::karatsuba_threshold = 1;
+    BigInteger::ntt_threshold = 1;
+    double ntt = Measure([&] { first * second; }, repeats);
+    BigInteger::karatsuba_threshold = karatsuba_threshold;
+    BigInteger::ntt_threshold = ntt_threshold;
+    if (crossover == 0 && ntt < schoolbook) crossover = blocks;
+    std::cerr << " " << blocks << " blocks: schoolbook " << schoolbook << " ms, Karatsuba/Toom-3 " << toom3
+              << " ms, NTT " << ntt << " ms" << std::endl;
+  }
+  std::cerr << " NTT overtakes schoolbook at " << crossover << " blocks, ntt_threshold is " << ntt_threshold
+            << std::endl;
+}
+
+void ParallelMultiplicationPerformanceTest() {
+  std::mt19937_64 gen(83);
+  size_t ntt_threshold = BigInteger::ntt_threshold;
+  for (size_t blocks : {20'000, 250'000}) {
+    BigInteger first(RandomDigits(gen, DigitsForBlocks(blocks)));
+    BigInteger second(RandomDigits(gen, DigitsForBlocks(blocks)));
+    // the smaller size is multiplied by Toom-3, the larger one by the NTT
+    BigInteger::ntt_threshold = blocks < 100'000 ? 1'000'000 : ntt_threshold;
+    std::cerr << " " << blocks << " blocks:";
+    BigInteger expected;
+    double single = 0;
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+      BigInteger::thread_count = threads;
+      BigInteger product;
+      double time = Measure([&] { product = first * second; });
+      if (threads == 1) {
+        expected = product;
+        single = time;
+      }
+      assert(product == expected);
+      std::cerr << " " << threads << " threads " << time << " ms (x" << single / time << ")"
+                << (threads == 16 ? "" : ",");
+    }
+    std::cerr << std::endl;
+    BigInteger::thread_count = 1;
+  }
+  BigInteger::ntt_threshold = ntt_threshold;
+  std::cerr << " " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+}
+
+void ProductPerformanceTest() {
+  for (size_t n : {2'000, 20'000}) {
+    BigInteger folded = 1;
+    double fold = Measure([&] {
+      folded = 1;
+      for (size_t i = 2; i <= n; ++i) folded *= BigInteger((long long) i);
+    });
+    std::vector<long long> factors(n);
+    std::iota(factors.begin(), factors.end(), 1);
+    BigInteger tree;
+    double product = Measure([&] { tree = BigInteger::product(factors.begin(), factors.end()); });
+    BigInteger swing;
+    double factorial = Measure([&] { swing = BigInteger::factorial(n); });
+    assert(tree == folded && swing == folded);
+    std::cerr << " " << n << "!: *= " << fold << " ms, product tree " << product << " ms, factorial " << factorial
+              << " ms" << std::endl;
+  }
+  size_t n = 100'000;
+  BigInteger folded;
+  double fold = Measure([&] {
+    folded = 1;
+    for (size_t i = 1; i <= n / 2; ++i) {
+      folded *= BigInteger((long long) (n / 2 + i));
+      folded /= BigInteger((long long) i);
+    }
+  });
+  BigInteger binomial;
+  double primes = Measure([&] { binomial = BigInteger::binomial(n, n / 2); });
+  assert(binomial == folded);
+  std::cerr << " binomial(" << n << ", " << n / 2 << "): *= and /= " << fold << " ms, binomial " << primes << " ms"
+            << std::endl;
+}
+
+void VectorizedKernelPerformanceTest() {
+  std::mt19937_64 gen(101);
+  // parsing a million blocks would take longer than the benchmark, so long numbers repeat a random piece
+  auto random_number = [&gen](size_t blocks) {
+    BigInteger piece(RandomDigits(gen, DigitsForBlocks(std::min<size_t>(blocks, 1000))));
+    BigInteger result = piece;
+    while (result.bit_length() < 32 * blocks) {
+      result <<= piece.bit_length();
+      result += piece;
+    }
+    return result;
+  };
+  for (size_t blocks : {10, 100, 10'000, 1'000'000}) {
+    BigInteger first = random_number(blocks);
+    BigInteger second = random_number(blocks);
+    BigInteger equal = first + 1;
+    int repeats = int(10'000'000 / blocks);
+    double times[2][3];
+    for (bool vectorize : {false, true}) {
+      BigInteger::vectorize = vectorize;
+      BigInteger sum = first;
+      times[vectorize][0] = Measure([&] {
+        for (int i = 0; i < repeats; ++i) sum += second;
+      }) / repeats;
+      times[vectorize][1] = Measure([&] {
+        for (int i = 0; i < repeats; ++i) sum -= second;
+      }) / repeats;
+      assert(sum == first);
+      bool less = true;
+      // equal differs from first in the lowest block only, so the whole number is scanned
+      times[vectorize][2] = Measure([&] {
+        for (int i = 0; i < repeats; ++i) less = less && first < equal;
+      }) / repeats;
+      assert(less);
+    }
+    std::cerr << " " << blocks << " blocks, scalar / AVX2 (us): += " << times[0][0] * 1000 << " / "
+              << times[1][0] * 1000 << ", -= " << times[0][1] * 1000 << " / " << times[1][1] * 1000 << ", < "
+              << times[0][2] * 1000 << " / " << times[1][2] * 1000 << std::endl;
+  }
+}
+
+void ComparisonPerformanceTest() {
+  std::mt19937_64 gen(107);
+  std::vector<std::pair<BigInteger, BigInteger>> fractions;
+  std::vector<Rational> rationals;
+  for (int i = 0; i < 20'000; ++i) {
+    BigInteger numerator = RandomBigInteger(gen, 1 + gen() % 100);
+    BigInteger denominator(RandomDigits(gen, 1 + gen() % 100));
+    rationals.push_back(Rational(numerator) / Rational(denominator));
+    fractions.emplace_back(numerator, denominator);
+  }
+  // the comparison of fractions as it was: two cross-multiplications per call
+  auto cross_multiplied = [](const auto& first, const auto& second) {
+    return first.first * second.second < second.first * first.second;
+  };
+  double cross = Measure([&] { std::sort(fractions.begin(), fractions.end(), cross_multiplied); });
+  double compare = Measure([&] { std::sort(rationals.begin(), rationals.end()); });
+  for (size_t i = 0; i < rationals.size(); ++i) {
+    assert(rationals[i] == Rational(fractions[i].first) / Rational(fractions[i].second));
+  }
+  std::cerr << " sorting 20000 fractions of up to 100 digits: cross-multiplied " << cross << " ms, compare "
+            << compare << " ms" << std::endl;
+}
+
+void BitwisePerformanceTest() {
+  std::mt19937_64 gen(113);
+  for (size_t digits : {100, 10'000, 100'000}) {
+    BigInteger number(RandomDigits(gen, digits));
+    size_t shift = number.bit_length() / 3;
+    BigInteger power = BigInteger(1) << shift;
+    BigInteger mask = power - 1;
+    int repeats = int(1'000'000 / digits);
+    BigInteger result;
+    double multiply = Measure([&] { result = number * power; }, repeats);
+    double left = Measure([&] { result = number << shift; }, repeats);
+    double divide = Measure([&] { result = number / power; }, repeats);
+    double right = Measure([&] { result = number >> shift; }, repeats);
+    double remainder = Measure([&] { result = number % power; }, repeats);
+    double low = Measure([&] { result = number & mask; }, repeats);
+    std::cerr << " " << digits << " digits (ms): * " << multiply << " / << " << left << ", / " << divide << " / >> "
+              << right << ", % " << remainder << " / & " << low << std::endl;
+  }
+}
+
+void RootPerformanceTest() {
+  std::mt19937_64 gen(131);
+  for (size_t digits : {1000, 5000}) {
+    BigInteger num(RandomDigits(gen, digits));
+    BigInteger square_root;
+    BigInteger cube_root;
+    double newton_square = Measure([&] { square_root = num.isqrt(); }, 10);
+    double newton_cube = Measure([&] { cube_root = num.iroot(3); }, 10);
+    double bisection_square = Measure([&] { assert(BisectionRoot(num, 2) == square_root); });
+    double bisection_cube = Measure([&] { assert(BisectionRoot(num, 3) == cube_root); });
+    std::cerr << " " << digits << " digits: square root by bisection " << bisection_square << " ms, isqrt "
+              << newton_square << " ms; cube root by bisection " << bisection_cube << " ms, iroot " << newton_cube
+              << " ms" << std::endl;
+  }
+  std::vector<BigInteger> numbers;
+  for (int i = 0; i < 1000; ++i) numbers.emplace_back(RandomDigits(gen, 3000));
+  size_t squares = 0;
+  double by_root = Measure([&] {
+    for (const auto& num : numbers) {
+      BigInteger root = num.isqrt();
+      squares += root * root == num;
+    }
+  });
+  double filtered = Measure([&] {
+    for (const auto& num : numbers) squares += num.is_perfect_square();
+  });
+  assert(squares == 0);
+  std::cerr << " 1000 squareness tests of 3000 digits: by isqrt " << by_root << " ms, is_perfect_square " << filtered
+            << " ms" << std::endl;
+}
+
+void SerializationPerformanceTest() {
+  std::mt19937_64 gen(139);
+  for (auto [count, digits] : {std::pair<size_t, size_t>{100'000, 100}, {20, 100'000}}) {
+    std::vector<BigInteger> numbers;
+    for (size_t i = 0; i < count; ++i) numbers.push_back(RandomBigInteger(gen, digits));
+    std::vector<BigInteger> read(count);
+    double text = Measure([&] {
+      std::stringstream stream;
+      for (const auto& num : numbers) stream << num << ' ';
+      for (auto& num : read) stream >> num;
+    });
+    assert(read == numbers);
+    size_t size = 0;
+    for (const auto& num : numbers) size += num.serialized_size();
+    std::vector<std::byte> buffer(size);
+    double binary = Measure([&] {
+      size_t offset = 0;
+      for (const auto& num : numbers) offset += num.serialize(std::span(buffer).subspan(offset));
+      offset = 0;
+      for (auto& num : read) {
+        num = BigInteger::deserialize(std::span(buffer).subspan(offset));
+        offset += num.serialized_size();
+      }
+    });
+    assert(read == numbers);
+    size_t bits = 0;
+    double view = Measure([&] {
+      for (size_t offset = 0; offset < size;) {
+        BigIntegerView number{std::span(buffer).subspan(offset)};
+        bits += number.blocks().size();
+        offset += number.size();
+      }
+    });
+    assert(bits > 0);
+    std::cerr << " " << count << " numbers of " << digits << " digits: text round trip " << text
+              << " ms, binary round trip " << binary << " ms, walking the views " << view << " ms" << std::endl;
+  }
+}
+
+void StreamReadPerformanceTest() {
+  std::mt19937_64 gen(151);
+  for (size_t digits : {100'000, 1'000'000}) {
+    std::string text = RandomDigits(gen, digits);
+    BigInteger through_string;
+    double string = Measure([&] {
+      std::stringstream stream(text);
+      std::string token;
+      stream >> token;
+      through_string = BigInteger(token);
+    });
+    BigInteger streamed;
+    double chunked = Measure([&] {
+      std::stringstream stream(text);
+      stream >> streamed;
+    });
+    assert(streamed == through_string);
+    std::cerr << " " << digits << " digits from a stream: through a string " << string << " ms, in chunks "
+              << chunked << " ms" << std::endl;
+  }
+}
+
+// the determinant of Matrix/matrix.cpp: Gaussian elimination that creates and drops a temporary for every entry
+template<size_t N, typename Field>
+class SquareMatrix {
+ public:
+  explicit SquareMatrix(std::vector<std::vector<Field>> entries) : matrix(std::move(entries)) {}
+  Field det() const {
+    std::vector<std::vector<Field>> copy = matrix;
+    Field result(1);
+    for (size_t column = 0; column < N; ++column) {
+      size_t leader_row = column;
+      while (leader_row < N && copy[leader_row][column] == Field(0)) ++leader_row;
+      if (leader_row == N) return Field(0);
+      if (leader_row != column) {
+        std::swap(copy[column], copy[leader_row]);
+        result *= Field(-1);
+      }
+      for (size_t j = column + 1; j < N; ++j) {
+        Field temp = copy[j][column] / copy[column][column];
+        for (size_t k = column; k < N; ++k) {
+          copy[j][k] -= copy[column][k] * temp;
+        }
+      }
+      result *= copy[column][column];
+    }
+    return result;
+  }
+
+ private:
+  std::vector<std::vector<Field>> matrix;
+};
+
+void PoolPerformanceTest() {
+  std::mt19937_64 gen(20);
+  std::vector<std::vector<Rational>> entries(20, std::vector<Rational>(20));
+  for (auto& row : entries) {
+    for (Rational& entry : row) entry = Rational(int(gen() % 201) - 100);
+  }
+  SquareMatrix<20, Rational> square(entries);
+  bool enabled = BlockPool::enabled;
+  // start from empty free lists rather than the leftovers of the other benchmarks
+  BlockPool::trim();
+  Rational pooled_det, heap_det;
+  BlockPool::enabled = false;
+  size_t before = allocations;
+  double heap = Measure([&] { heap_det = square.det(); }, 3);
+  size_t heap_allocations = (allocations - before) / 3;
+  BlockPool::enabled = true;
+  square.det();
+  before = allocations;
+  double pooled = Measure([&] { pooled_det = square.det(); }, 3);
+  size_t pooled_allocations = (allocations - before) / 3;
+  assert(pooled_det == heap_det);
+  BlockPool::trim();
+  BlockPool::enabled = enabled;
+  std::cerr << " SquareMatrix<20, Rational>::det(): without the pool " << heap << " ms (" << heap_allocations
+            << " allocations), with the pool " << pooled << " ms (" << pooled_allocations << " allocations)"
+            << std::endl;
+}
+
+// where a Rational workload spends its time, as reported by the counters
+void StatsPerformanceTest() {
+  std::mt19937_64 gen(24);
+  std::vector<std::vector<Rational>> entries(12, std::vector<Rational>(12));
+  for (auto& row : entries) {
+    for (Rational& entry : row) entry = Rational(int(gen() % 2001) - 1000) / Rational(int(gen() % 99) + 1);
+  }
+  SquareMatrix<12, Rational> square(entries);
+  BigIntegerStats::reset();
+  double time = Measure([&] { square.det(); });
+  std::cerr << " SquareMatrix<12, Rational>::det() of fractions: " << time << " ms" << std::endl;
+  BigIntegerStats::dump_stats(std::cerr);
+}
+
+void FusedExpressionPerformanceTest() {
+  std::mt19937_64 gen(25);
+  bool enabled = BlockPool::enabled;
+  BlockPool::enabled = false;
+  for (size_t digits : {50, 250, 2000, 20000}) {
+    std::vector<BigInteger> values;
+    for (int i = 0; i < 60; ++i) values.push_back(RandomBigInteger(gen, digits));
+    int repeats = int(200000 / digits) + 1;
+    BigInteger eager_result, fused_result;
+    size_t before = allocations;
+    double eager = Measure([&] {
+      for (size_t i = 0; i + 4 < values.size(); ++i) {
+        eager_result = values[i] * values[i + 1] + values[i + 2] * values[i + 3] - values[i + 4];
+      }
+    }, repeats);
+    size_t eager_allocations = allocations - before;
+    before = allocations;
+    double fused_time = Measure([&] {
+      for (size_t i = 0; i + 4 < values.size(); ++i) {
+        fused_result = fused(values[i]) * values[i + 1] + fused(values[i + 2]) * values[i + 3] - values[i + 4];
+      }
+    }, repeats);
+    size_t fused_allocations = allocations - before;
+    assert(eager_result == fused_result);
+    double expressions = double(repeats) * double(values.size() - 4);
+    std::cerr << " a * b + c * d - e, " << digits << " digits: eager " << eager * 1e3 / double(values.size() - 4)
+              << " us (" << double(eager_allocations) / expressions << " allocations), fused "
+              << fused_time * 1e3 / double(values.size() - 4) << " us ("
+              << double(fused_allocations) / expressions << " allocations)" << std::endl;
+  }
+  BlockPool::enabled = enabled;
+}
+
+int main() {
+  BasicTest();
+
+  std::cerr << "Test 1 (Basic) passed." << std::endl;
+
+  MultiplicationTest();
+
+  std::cerr << "Test 2 (Multiplication) passed." << std::endl;
+
+  NttTest();
+
+  std::cerr << "Test 3 (NTT) passed." << std::endl;
+
+  DivisionTest();
+
+  std::cerr << "Test 4 (Division) passed." << std::endl;
+
+  NewtonDivisionTest();
+
+  std::cerr << "Test 5 (Newton division) passed." << std::endl;
+
+  DecimalConversionTest();
+
+  std::cerr << "Test 6 (Decimal conversion) passed." << std::endl;
+
+  MoveTest();
+
+  std::cerr << "Test 7 (Move) passed." << std::endl;
+
+  GcdTest();
+
+  std::cerr << "Test 8 (GCD) passed." << std::endl;
+
+  LazyRationalTest();
+
+  std::cerr << "Test 9 (Lazy rational) passed." << std::endl;
+
+  DecimalRationalTest();
+
+  std::cerr << "Test 10 (Rational to decimal and double) passed." << std::endl;
+
+  FixedBigIntegerTest();
+
+  std::cerr << "Test 11 (Fixed-width integers) passed." << std::endl;
+
+  LiteralTest();
+
+  std::cerr << "Test 12 (Literals and compile-time tables) passed." << std::endl;
+
+  PowModTest();
+
+  std::cerr << "Test 13 (Modular exponentiation) passed." << std::endl;
+
+  ParallelMultiplicationTest();
+
+  std::cerr << "Test 14 (Parallel multiplication) passed." << std::endl;
+
+  ProductTest();
+
+  std::cerr << "Test 15 (Products, factorials and binomials) passed." << std::endl;
+
+  VectorizedKernelTest();
+
+  std::cerr << "Test 16 (Vectorized block kernels) passed." << std::endl;
+
+  ComparisonTest();
+
+  std::cerr << "Test 17 (Comparison) passed." << std::endl;
+
+  BitwiseTest();
+
+  std::cerr << "Test 18 (Bitwise operations) passed." << std::endl;
+
+  RootTest();
+
+  std::cerr << "Test 19 (Roots and perfect powers) passed." << std::endl;
+
+  SerializationTest();
+
+  std::cerr << "Test 20 (Binary serialization) passed." << std::endl;
+
+  StreamReadTest();
+
+  std::cerr << "Test 21 (Streaming input) passed." << std::endl;
+
+  PoolTest();
+
+  std::cerr << "Test 22 (Limb pool) passed." << std::endl;
+
+  StatsTest();
+
+  std::cerr << "Test 23 (Statistics) passed." << std::endl;
+
+  FusedExpressionTest();
+
+  std::cerr << "Test 24 (Fused expressions) passed." << std::endl;
+
+  std::cerr << "Starting performance test." << std::endl;
+
+  MultiplicationPerformanceTest();
+
+  NttPerformanceTest();
+
+  DivisionPerformanceTest();
+
+  DecimalConversionPerformanceTest();
+
+  RationalAllocationPerformanceTest();
+
+  ExpressionAllocationPerformanceTest();
+
+  GcdPerformanceTest();
+
+  LazyRationalPerformanceTest();
+
+  DecimalRationalPerformanceTest();
+
+  FixedBigIntegerPerformanceTest();
+
+  LiteralPerformanceTest();
+
+  PowModPerformanceTest();
+
+  ParallelMultiplicationPerformanceTest();
+
+  ProductPerformanceTest();
+
+  VectorizedKernelPerformanceTest();
+
+  ComparisonPerformanceTest();
+
+  BitwisePerformanceTest();
+
+  RootPerformanceTest();
+
+  SerializationPerformanceTest();
+
+  StreamReadPerformanceTest();
+
+  PoolPerformanceTest();
+
+  StatsPerformanceTest();
+
+  FusedExpressionPerformanceTest();
+
+  std::cerr << "Tests passed." << std::endl;
+
+  std::cout << 0;
+}